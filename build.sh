@@ -7,12 +7,35 @@ else
     rm -f bin/*
 fi
 
+# Add -DINTERRUPTS_PROFILE to any simulator below to have each run print where its main loop
+# spends its time to stderr
+
 # Compile the three schedulers using your actual filenames
-g++ -std=c++17 -g -O0 -I . -o bin/interrupts_EP \
+g++ -std=c++17 -g -O0 -I . -pthread -o bin/interrupts_EP \
     interrupts_101299776_101287534_EP.cpp
 
-g++ -std=c++17 -g -O0 -I . -o bin/interrupts_RR \
+g++ -std=c++17 -g -O0 -I . -pthread -o bin/interrupts_RR \
     interrupts_101299776_101287534_RR.cpp
 
-g++ -std=c++17 -g -O0 -I . -o bin/interrupts_EP_RR \
+g++ -std=c++17 -g -O0 -I . -pthread -o bin/interrupts_EP_RR \
     interrupts_101299776_101287534_EP_RR.cpp
+
+# Renderer for the binary traces written with --trace
+g++ -std=c++17 -g -O0 -I . -o bin/interrupts_trace \
+    interrupts_101299776_101287534_trace.cpp
+
+# Single simulator for every policy, picked with --policy
+g++ -std=c++17 -g -O0 -I . -pthread -o bin/interrupts \
+    interrupts_101299776_101287534.cpp
+
+# Synthetic workload generator for stress testing
+g++ -std=c++17 -g -O0 -I . -o bin/interrupts_generate \
+    interrupts_101299776_101287534_generate.cpp
+
+# Throughput benchmarks over generated workloads
+g++ -std=c++17 -g -O0 -I . -pthread -o bin/interrupts_bench \
+    interrupts_101299776_101287534_bench.cpp
+
+# Regression test against the reference results in output_files, run with ./test.sh
+g++ -std=c++17 -g -O0 -I . -pthread -o bin/interrupts_test \
+    interrupts_101299776_101287534_test.cpp
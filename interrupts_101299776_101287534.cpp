@@ -0,0 +1,686 @@
+/**
+ * @file interrupts_101299776_101287534.cpp
+ * @brief Simulator that runs any of the scheduling policies, picked with --policy (EP by default),
+ *        every combination of a set of scenarios and policies in parallel with --batch, a range
+ *        of time quanta in parallel with --sweep, the rest of a checkpointed run with --resume, or
+ *        several policies and quanta forked off one shared run with --whatif
+ *
+ */
+
+#include "interrupts_101299776_101287534_engine.hpp"
+#include <filesystem>
+#include <map>
+#include <sys/wait.h>
+
+
+// One simulation of a batch
+struct batch_job {
+    std::size_t     scenario;   // Index into the loaded scenarios
+    std::string     policy;
+    std::string     output_file;
+    bool            written = false;
+    std::size_t     stranded = 0;
+};
+
+void print_batch_usage(const char* program) {
+    std::cout << "To run a batch, do: " << program << " --batch <input file or directory>... [--policies <EP,RR,EP_RR>]"
+              << " [--out <directory>] [--jobs <threads>] [--quantum <ms>] [--cores <n>] [--partitions <partition_file>]"
+              << " [--stop-when <idle|done>]" << std::endl;
+    std::cout << "  Every .txt file in a directory is a scenario. Each scenario is run under each policy and written to"
+              << " <out>/<policy>_<scenario>.txt, like output_files/." << std::endl;
+}
+
+//Runs every scenario under every policy on a pool of threads, each writing its own output file
+int batch_main(int argc, char** argv) {
+    std::vector<std::string> inputs;
+    std::vector<std::string> policies = {external_priorities::name, round_robin::name, external_priorities_rr::name};
+    std::string output_dir = "output_files";
+    unsigned int jobs = 0;
+    simulator_options options;
+
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool valid = true;
+        if (option.rfind("--", 0) != 0) {
+            inputs.push_back(option);
+        } else if (i + 1 < argc && option == "--policies") {
+            policies = split_delim(argv[++i], ",");
+        } else if (i + 1 < argc && option == "--out") {
+            output_dir = argv[++i];
+        } else if (i + 1 < argc && option == "--jobs") {
+            valid = parse_number(argv[++i], jobs);
+        } else if (i + 1 < argc && option == "--quantum") {
+            valid = parse_number(argv[++i], options.time_quantum) && options.time_quantum > 0;
+        } else if (i + 1 < argc && option == "--cores") {
+            valid = parse_number(argv[++i], options.cores) && options.cores > 0;
+        } else if (i + 1 < argc && option == "--partitions") {
+            options.partition_file = argv[++i];
+        } else if (i + 1 < argc && option == "--stop-when") {
+            valid = parse_stop_rule(argv[++i], options.run_to_completion);
+        } else {
+            std::cout << "ERROR!\nUnknown option: " << option << std::endl;
+            print_batch_usage(argv[0]);
+            return -1;
+        }
+
+        if (!valid) {
+            std::cout << "ERROR!\nInvalid option: " << option << " " << argv[i] << std::endl;
+            print_batch_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cout << "ERROR!\nExpected at least one input file or directory" << std::endl;
+        print_batch_usage(argv[0]);
+        return -1;
+    }
+
+    // Expand directories into the scenario files they hold
+    std::vector<std::filesystem::path> scenario_files;
+    for (const auto &input : inputs) {
+        if (std::filesystem::is_directory(input)) {
+            std::vector<std::filesystem::path> files;
+            for (const auto &entry : std::filesystem::directory_iterator(input)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                    files.push_back(entry.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            scenario_files.insert(scenario_files.end(), files.begin(), files.end());
+        } else {
+            scenario_files.push_back(input);
+        }
+    }
+
+    simulation_settings settings;
+    settings.time_quantum = options.time_quantum;
+    settings.cores = options.cores;
+    settings.run_to_completion = options.run_to_completion;
+    settings.print_loaded = false;
+    if (settings.time_quantum == 0 || settings.cores == 0 || !setup_partitions(options, settings.layout)) {
+        return -1;
+    }
+
+    // Every scenario is parsed once, up front, and shared by the simulations of all policies
+    std::vector<std::vector<PCB>> scenarios(scenario_files.size());
+    for (std::size_t i = 0; i < scenario_files.size(); i++) {
+        if (!load_processes(scenario_files[i].c_str(), scenarios[i])) {
+            return -1;
+        }
+    }
+
+    std::vector<batch_job> batch;
+    for (const auto &policy : policies) {
+        std::string prefix;
+        bool known = with_policy(policy, [&](auto policy_type) {
+            prefix = decltype(policy_type)::file_prefix;
+        });
+        if (!known) {
+            std::cout << "ERROR!\nUnknown policy: " << policy << std::endl;
+            print_batch_usage(argv[0]);
+            return -1;
+        }
+
+        for (std::size_t i = 0; i < scenario_files.size(); i++) {
+            std::string name = prefix + "_" + scenario_files[i].stem().string() + ".txt";
+            batch.push_back({i, policy, (std::filesystem::path(output_dir) / name).string()});
+        }
+    }
+
+    // Two jobs writing the same file (e.g. scenarios with the same name in different directories) would
+    // overwrite each other's output
+    std::map<std::string, std::size_t> writers;
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        auto writer = writers.emplace(batch[i].output_file, i);
+        if (!writer.second) {
+            const batch_job &first = batch[writer.first->second];
+            std::cout << "ERROR!\n" << scenario_files[first.scenario].string() << " under " << first.policy << " and "
+                      << scenario_files[batch[i].scenario].string() << " under " << batch[i].policy
+                      << " would both be written to " << batch[i].output_file << std::endl;
+            return -1;
+        }
+    }
+
+    std::filesystem::create_directories(output_dir);
+
+    parallel_for(batch.size(), jobs, [&](std::size_t i) {
+        batch_job &job = batch[i];
+        output_sink exec;
+        if (!exec.open(job.output_file.c_str())) {
+            return;
+        }
+
+        trace_writer no_trace;
+        with_policy(job.policy, [&](auto policy_type) {
+            job.stranded = run_simulation<decltype(policy_type)>(scenarios[job.scenario], settings, exec, no_trace).stranded;
+        });
+        exec.close();
+        job.written = true;
+    });
+
+    // Report once every thread is done so the messages don't interleave
+    int status = 0;
+    for (const auto &job : batch) {
+        if (job.written) {
+            std::cout << "Output generated in " << job.output_file << std::endl;
+        } else {
+            std::cerr << "Error: Unable to write " << job.output_file << std::endl;
+            status = -1;
+        }
+        if (!check_stranded(job.output_file, job.stranded)) {
+            status = -1;
+        }
+    }
+    return status;
+}
+
+// One simulation of a quantum sweep
+struct sweep_point {
+    std::string         policy;
+    unsigned int        cores;
+    unsigned int        time_quantum;
+    schedule_metrics    metrics;
+};
+
+void print_sweep_usage(const char* program) {
+    std::cout << "To sweep time quanta, do: " << program << " --sweep <your_input_file.txt> [--quanta <first>:<last>:<step>]"
+              << " [--policies <RR,EP_RR>] [--cores <n,...>] [--jobs <threads>] [--partitions <partition_file>]" << std::endl;
+}
+
+//Simulates one scenario for a range of time quanta (and core counts) on a pool of threads and prints
+//the average turnaround, waiting and response time for each, and the tail of the turnaround and waiting time
+int sweep_main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "ERROR!\nExpected an input file" << std::endl;
+        print_sweep_usage(argv[0]);
+        return -1;
+    }
+
+    std::vector<std::string> policies = {round_robin::name, external_priorities_rr::name};
+    std::vector<unsigned int> core_counts = {1};
+    unsigned int first = 10, last = 200, step = 10;
+    unsigned int jobs = 0;
+    simulator_options options;
+
+    for (int i = 3; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 < argc && option == "--quanta") {
+            auto range = split_delim(argv[++i], ":");
+            if (range.size() != 3 || !parse_number(range[0], first) || !parse_number(range[1], last)
+                || !parse_number(range[2], step)) {
+                std::cout << "ERROR!\nExpected --quanta <first>:<last>:<step>, received " << argv[i] << std::endl;
+                print_sweep_usage(argv[0]);
+                return -1;
+            }
+        } else if (i + 1 < argc && option == "--policies") {
+            policies = split_delim(argv[++i], ",");
+        } else if (i + 1 < argc && option == "--cores") {
+            core_counts.clear();
+            for (const auto &count : split_delim(argv[++i], ",")) {
+                unsigned int cores;
+                if (!parse_number(count, cores) || cores == 0) {
+                    std::cout << "ERROR!\nEvery core count has to be a positive number, received " << argv[i] << std::endl;
+                    print_sweep_usage(argv[0]);
+                    return -1;
+                }
+                core_counts.push_back(cores);
+            }
+        } else if (i + 1 < argc && option == "--jobs") {
+            if (!parse_number(argv[++i], jobs)) {
+                std::cout << "ERROR!\nInvalid option: " << option << " " << argv[i] << std::endl;
+                print_sweep_usage(argv[0]);
+                return -1;
+            }
+        } else if (i + 1 < argc && option == "--partitions") {
+            options.partition_file = argv[++i];
+        } else {
+            std::cout << "ERROR!\nUnknown option: " << option << std::endl;
+            print_sweep_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (first == 0 || step == 0 || first > last) {
+        std::cout << "ERROR!\nThe quanta have to be a non-empty range of positive values" << std::endl;
+        return -1;
+    }
+
+    simulation_settings settings;
+    settings.print_loaded = false;
+    settings.write_logs = false;    // Only the metrics are needed
+    settings.run_to_completion = true; // Otherwise an idle gap would end the run and only average the processes before it
+    std::vector<PCB> list_process;
+    if (!setup_partitions(options, settings.layout) || !load_processes(argv[2], list_process)) {
+        return -1;
+    }
+
+    std::vector<sweep_point> sweep;
+    for (const auto &policy : policies) {
+        if (!with_policy(policy, [](auto) {})) {
+            std::cout << "ERROR!\nUnknown policy: " << policy << std::endl;
+            print_sweep_usage(argv[0]);
+            return -1;
+        }
+        for (unsigned int cores : core_counts) {
+            for (unsigned long long quantum = first; quantum <= last; quantum += step) {
+                sweep.push_back({policy, cores, (unsigned int) quantum, {}});
+            }
+        }
+    }
+
+    parallel_for(sweep.size(), jobs, [&](std::size_t i) {
+        sweep_point &point = sweep[i];
+        simulation_settings point_settings = settings;
+        point_settings.time_quantum = point.time_quantum;
+        point_settings.cores = point.cores;
+
+        output_sink no_output;
+        trace_writer no_trace;
+        with_policy(point.policy, [&](auto policy_type) {
+            point.metrics = run_simulation<decltype(policy_type)>(list_process, point_settings, no_output, no_trace);
+        });
+    });
+
+    std::cout << std::left << std::setw(8) << "Policy" << std::right
+              << std::setw(7) << "Cores"
+              << std::setw(10) << "Quantum"
+              << std::setw(18) << "Avg Turnaround"
+              << std::setw(15) << "Avg Waiting"
+              << std::setw(16) << "Avg Response"
+              << std::setw(16) << "p95 Turnaround"
+              << std::setw(13) << "p95 Waiting"
+              << std::setw(12) << "Completed" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto &point : sweep) {
+        const schedule_metrics &metrics = point.metrics;
+        std::cout << std::left << std::setw(8) << point.policy << std::right
+                  << std::setw(7) << point.cores
+                  << std::setw(10) << point.time_quantum
+                  << std::setw(18) << metrics.average(metrics.total_turnaround)
+                  << std::setw(15) << metrics.average(metrics.total_waiting)
+                  << std::setw(16) << metrics.average(metrics.total_response)
+                  << std::setw(16) << metrics.turnaround.percentile(0.95)
+                  << std::setw(13) << metrics.waiting.percentile(0.95)
+                  << std::setw(12) << metrics.completed << std::endl;
+    }
+
+    int status = 0;
+    for (const auto &point : sweep) {
+        std::string run = point.policy + " at quantum " + std::to_string(point.time_quantum) + " on "
+                          + std::to_string(point.cores) + (point.cores == 1 ? " core" : " cores");
+        if (!check_stranded(run, point.metrics.stranded) || !check_admitted(run, point.metrics.never_admitted)) {
+            status = -1;
+        }
+    }
+    return status;
+}
+
+void print_resume_usage(const char* program) {
+    std::cout << "To resume from a checkpoint, do: " << program << " --resume <checkpoint_file> [--threads <n>]"
+              << " [--metrics <metrics_file or ->] [--checkpoint <file> --checkpoint-at <ms> | --checkpoint-every <ms>]" << std::endl;
+    std::cout << "  Run it where the checkpointed run wrote execution.txt, with <checkpoint_file>.memory next to the"
+              << " checkpoint. The policy, quantum, cores, partitions, trace and --stop-when are the checkpointed run's."
+              << std::endl;
+}
+
+//Continues a run from a checkpoint saved with --checkpoint
+int resume_main(int argc, char** argv) {
+    simulator_options options;
+    // The options after the checkpoint file are parsed like those after an input file
+    if (argc < 3) {
+        std::cout << "ERROR!\nExpected a checkpoint file followed by options" << std::endl;
+        print_resume_usage(argv[0]);
+        return -1;
+    }
+    if (!parse_options(argc - 1, argv + 1, options)) {
+        print_resume_usage(argv[0]);
+        return -1;
+    }
+
+    // The rest of the run has to be simulated the way its start was
+    const char* fixed[] = {"--policy", "--quantum", "--cores", "--trace", "--partitions", "--stop-when"};
+    for (int i = 3; i < argc; i += 2) {
+        if (std::find(std::begin(fixed), std::end(fixed), std::string(argv[i])) != std::end(fixed)) {
+            std::cout << "ERROR!\n" << argv[i] << " can't be changed when resuming, the checkpointed run's is kept" << std::endl;
+            print_resume_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    checkpoint_reader checkpoint;
+    checkpoint_header header;
+    if (!checkpoint.open(argv[2]) || !header.load(checkpoint)) {
+        std::cerr << "Error: " << argv[2] << " is not a checkpoint file" << std::endl;
+        return -1;
+    }
+
+    simulation_settings settings;
+    settings.time_quantum = header.time_quantum;
+    settings.cores = header.cores;
+    settings.run_to_completion = header.run_to_completion;
+    settings.threads = options.threads;
+    settings.checkpoint_file = options.checkpoint_file;
+    settings.checkpoint_at = options.checkpoint_at;
+    settings.checkpoint_every = options.checkpoint_every;
+
+    int status = -1;
+    bool known = with_policy(header.policy, [&](auto policy_type) {
+        status = resume<decltype(policy_type)>(options, settings, header, checkpoint);
+    });
+    if (!known) {
+        std::cerr << "Error: Unknown policy in checkpoint: " << header.policy << std::endl;
+    }
+    return status;
+}
+
+// One branch of a what-if run
+struct whatif_variant {
+    std::string     policy;
+    unsigned int    time_quantum;
+    std::string     output_file;
+    std::string     label;          // POLICY:quantum, or just POLICY for one that ignores the quantum
+};
+
+// What a branch measured. Passed from the child process that ran it through a pipe.
+struct whatif_result {
+    bool            ok = false;
+    unsigned int    finish_time = 0;
+    std::size_t     completed = 0;
+    double          average_turnaround = 0;
+    double          average_waiting = 0;
+    double          average_response = 0;
+    unsigned int    p95_turnaround = 0;
+    unsigned int    p95_waiting = 0;
+    std::size_t     stranded = 0;
+    std::size_t     never_admitted = 0;
+};
+
+void print_whatif_usage(const char* program) {
+    std::cout << "To compare policies from a shared start, do: " << program << " --whatif <your_input_file.txt>"
+              << " --variants <POLICY[:quantum],...> [--fork-at <ms>] [--policy <EP|RR|EP_RR>] [--quantum <ms>]"
+              << " [--cores <n>] [--threads <n>] [--partitions <partition_file>] [--out <directory>]"
+              << " [--stop-when <idle|done>]" << std::endl;
+    std::cout << "  Runs the first --fork-at ms once under --policy, then every variant from there on in parallel."
+              << " Variants have to write the same table as --policy, so EP and RR mix but EP_RR only forks into EP_RR."
+              << " Every variant runs until all input processes are done unless --stop-when is idle." << std::endl;
+}
+
+//Continues the prefix in a branch under the variant's policy and quantum, writing its own output file.
+//Runs in a forked child, so the prefix it takes apart is the child's copy-on-write copy.
+template<typename Base>
+whatif_result run_branch(simulation<Base> &prefix, simulation_settings settings, const whatif_variant &variant,
+                         output_sink &exec, const std::string &prefix_exec, const std::string &prefix_memory) {
+    whatif_result result;
+    exec.close(); // The prefix's scratch file
+    if (!exec.open(variant.output_file.c_str())) {
+        return result;
+    }
+    exec << prefix_exec;
+
+    settings.time_quantum = variant.time_quantum;
+    trace_writer no_trace;
+    with_policy(variant.policy, [&](auto policy_type) {
+        simulation<decltype(policy_type)> branch({}, settings, exec, no_trace);
+        branch.adopt(prefix);
+        branch.start();
+        branch.memory_status << prefix_memory;
+        branch.run_until(NO_EVENT);
+        branch.finish();
+
+        const schedule_metrics &metrics = branch.metrics;
+        result.finish_time = metrics.finish_time;
+        result.completed = metrics.completed;
+        result.average_turnaround = metrics.average(metrics.total_turnaround);
+        result.average_waiting = metrics.average(metrics.total_waiting);
+        result.average_response = metrics.average(metrics.total_response);
+        result.p95_turnaround = metrics.turnaround.percentile(0.95);
+        result.p95_waiting = metrics.waiting.percentile(0.95);
+        result.stranded = metrics.stranded;
+        result.never_admitted = metrics.never_admitted;
+    });
+    exec.close();
+    result.ok = true;
+    return result;
+}
+
+//Simulates one scenario up to --fork-at once, then forks a process per variant that continues it
+//under that variant's policy and quantum, and prints what each variant measured
+int whatif_main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "ERROR!\nExpected an input file" << std::endl;
+        print_whatif_usage(argv[0]);
+        return -1;
+    }
+
+    std::vector<std::string> specs;
+    std::string output_dir = "whatif";
+    std::string base_policy = external_priorities::name;
+    unsigned int fork_at = 0;
+    simulator_options options;
+    options.run_to_completion = true; // Variants are compared on every input process, not just those before an idle gap
+
+    for (int i = 3; i < argc; i++) {
+        std::string option = argv[i];
+        bool valid = true;
+        if (i + 1 < argc && option == "--variants") {
+            specs = split_delim(argv[++i], ",");
+        } else if (i + 1 < argc && option == "--fork-at") {
+            valid = parse_number(argv[++i], fork_at);
+        } else if (i + 1 < argc && option == "--policy") {
+            base_policy = argv[++i];
+        } else if (i + 1 < argc && option == "--quantum") {
+            valid = parse_number(argv[++i], options.time_quantum);
+        } else if (i + 1 < argc && option == "--cores") {
+            valid = parse_number(argv[++i], options.cores);
+        } else if (i + 1 < argc && option == "--threads") {
+            valid = parse_number(argv[++i], options.threads);
+        } else if (i + 1 < argc && option == "--partitions") {
+            options.partition_file = argv[++i];
+        } else if (i + 1 < argc && option == "--out") {
+            output_dir = argv[++i];
+        } else if (i + 1 < argc && option == "--stop-when") {
+            valid = parse_stop_rule(argv[++i], options.run_to_completion);
+        } else {
+            std::cout << "ERROR!\nUnknown option: " << option << std::endl;
+            print_whatif_usage(argv[0]);
+            return -1;
+        }
+
+        if (!valid) {
+            std::cout << "ERROR!\nInvalid option: " << option << " " << argv[i] << std::endl;
+            print_whatif_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    table_style base_style = TABLE_BOXED;
+    if (!with_policy(base_policy, [&](auto policy_type) { base_style = decltype(policy_type)::style; })) {
+        std::cout << "ERROR!\nUnknown policy: " << base_policy << std::endl;
+        return -1;
+    }
+    if (specs.empty() || options.time_quantum == 0 || options.cores == 0 || options.threads == 0) {
+        std::cout << "ERROR!\nExpected at least one variant, and a positive quantum, core and thread count" << std::endl;
+        print_whatif_usage(argv[0]);
+        return -1;
+    }
+
+    // Every variant is POLICY or POLICY:quantum. A policy that doesn't slice time runs the same whatever
+    // the quantum, so it is one variant named without it.
+    std::vector<whatif_variant> variants;
+    std::string stem = std::filesystem::path(argv[2]).stem().string();
+    for (const auto &spec : specs) {
+        auto fields = split_delim(spec, ":");
+        whatif_variant variant = {fields[0], options.time_quantum, "", fields[0]};
+        std::string prefix;
+        table_style style = TABLE_BOXED;
+        bool time_sliced = false;
+        bool known = with_policy(variant.policy, [&](auto policy_type) {
+            prefix = decltype(policy_type)::file_prefix;
+            style = decltype(policy_type)::style;
+            time_sliced = decltype(policy_type)::time_sliced;
+        });
+        bool valid_quantum = fields.size() != 2 || parse_number(fields[1], variant.time_quantum);
+        if (!known || !valid_quantum || fields.size() > 2 || variant.time_quantum == 0 || style != base_style) {
+            std::cout << "ERROR!\nInvalid variant for " << base_policy << ": " << spec << std::endl;
+            print_whatif_usage(argv[0]);
+            return -1;
+        }
+        std::string quantum = time_sliced ? "_q" + std::to_string(variant.time_quantum) : "";
+        if (time_sliced) {
+            variant.label += ":" + std::to_string(variant.time_quantum);
+        }
+        std::string name = prefix + quantum + "_" + stem + ".txt";
+        variant.output_file = (std::filesystem::path(output_dir) / name).string();
+        bool duplicate = std::any_of(variants.begin(), variants.end(), [&](const whatif_variant &other) {
+            return other.label == variant.label;
+        });
+        if (!duplicate) {
+            variants.push_back(variant);
+        }
+    }
+
+    simulation_settings settings;
+    settings.time_quantum = options.time_quantum;
+    settings.cores = options.cores;
+    settings.run_to_completion = options.run_to_completion;
+    settings.print_loaded = false;
+    std::vector<PCB> list_process;
+    if (!setup_partitions(options, settings.layout) || !load_processes(argv[2], list_process)) {
+        return -1;
+    }
+    std::filesystem::create_directories(output_dir);
+
+    std::vector<whatif_result> results(variants.size());
+    with_policy(base_policy, [&](auto policy_type) {
+        using Base = decltype(policy_type);
+
+        // The shared prefix, with its output kept aside to start every branch's file with
+        output_sink exec;
+        exec.open_temporary();
+        trace_writer no_trace;
+        simulation<Base> prefix(std::move(list_process), settings, exec, no_trace);
+        prefix.start();
+        prefix.run_until(fork_at);
+
+        std::string prefix_exec, prefix_memory;
+        output_sink capture;
+        capture.capture(prefix_exec);
+        capture.append(exec);
+        capture.close();
+        capture.capture(prefix_memory);
+        capture.append(prefix.memory_status);
+        capture.close();
+
+        // Branches only need the threads they format their logs with, so they start after forking
+        simulation_settings branch_settings = settings;
+        branch_settings.threads = options.threads;
+
+        std::cout.flush();
+        std::vector<pid_t> children(variants.size(), -1);
+        std::vector<int> channels(variants.size(), -1);
+        for (std::size_t i = 0; i < variants.size(); i++) {
+            int channel[2];
+            if (pipe(channel) != 0) {
+                continue;
+            }
+            children[i] = fork();
+            if (children[i] == 0) {
+                close(channel[0]);
+                whatif_result result = run_branch(prefix, branch_settings, variants[i], exec, prefix_exec, prefix_memory);
+                ssize_t written = write(channel[1], &result, sizeof(result));
+                close(channel[1]);
+                _exit(written == sizeof(result) ? 0 : 1);
+            }
+            close(channel[1]);
+            if (children[i] < 0) {
+                close(channel[0]);
+            } else {
+                channels[i] = channel[0];
+            }
+        }
+
+        for (std::size_t i = 0; i < variants.size(); i++) {
+            if (channels[i] < 0) {
+                continue;
+            }
+            if (read(channels[i], &results[i], sizeof(results[i])) != sizeof(results[i])) {
+                results[i].ok = false;
+            }
+            close(channels[i]);
+            waitpid(children[i], nullptr, 0);
+        }
+    });
+
+    int status = 0;
+    for (std::size_t i = 0; i < variants.size(); i++) {
+        if (results[i].ok) {
+            std::cout << "Output generated in " << variants[i].output_file << std::endl;
+        } else {
+            std::cerr << "Error: Unable to write " << variants[i].output_file << std::endl;
+            status = -1;
+        }
+        if (!check_stranded(variants[i].output_file, results[i].stranded)) {
+            status = -1;
+        }
+    }
+
+    std::cout << std::left << std::setw(12) << "Variant" << std::right
+              << std::setw(18) << "Avg Turnaround"
+              << std::setw(15) << "Avg Waiting"
+              << std::setw(16) << "Avg Response"
+              << std::setw(16) << "p95 Turnaround"
+              << std::setw(13) << "p95 Waiting"
+              << std::setw(12) << "Completed"
+              << std::setw(14) << "Not arrived" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (std::size_t i = 0; i < variants.size(); i++) {
+        const whatif_result &result = results[i];
+        std::cout << std::left << std::setw(12) << variants[i].label << std::right
+                  << std::setw(18) << result.average_turnaround
+                  << std::setw(15) << result.average_waiting
+                  << std::setw(16) << result.average_response
+                  << std::setw(16) << result.p95_turnaround
+                  << std::setw(13) << result.p95_waiting
+                  << std::setw(12) << result.completed
+                  << std::setw(14) << result.never_admitted << std::endl;
+    }
+    return status;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--whatif") {
+        return whatif_main(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--resume") {
+        return resume_main(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--batch") {
+        return batch_main(argc, argv);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--sweep") {
+        return sweep_main(argc, argv);
+    }
+
+    simulator_options options;
+    simulation_settings settings;
+    std::vector<PCB> list_process;
+    if (!load_simulation(argc, argv, options, settings, list_process)) {
+        return -1;
+    }
+
+    int status = -1;
+    std::string policy = options.policy ? options.policy : external_priorities::name;
+    bool known = with_policy(policy, [&](auto policy_type) {
+        status = simulate<decltype(policy_type)>(options, settings, std::move(list_process));
+    });
+    if (!known) {
+        std::cout << "ERROR!\nUnknown policy: " << policy << std::endl;
+        print_usage(argv[0]);
+        print_batch_usage(argv[0]);
+        print_sweep_usage(argv[0]);
+        print_resume_usage(argv[0]);
+        print_whatif_usage(argv[0]);
+    }
+    return status;
+}
@@ -19,8 +19,20 @@
 #include<iomanip>
 #include<algorithm>
 #include <queue>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <type_traits>
+#include <set>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-#define TIME_QUANTUM 100
+#define TIME_QUANTUM 100 // Default time slice, --quantum picks another one at runtime
+#define NO_EVENT UINT_MAX // Returned by the next event helpers when nothing is left to happen
 
 
 //An enumeration of states to make assignment easier
@@ -32,9 +44,8 @@ enum states {
     TERMINATED,
     NOT_ASSIGNED
 };
-std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading the << operator to make printing of the enum easier
-
-	std::string state_names[] = {
+const char* state_name(enum states s) {
+    static const char* state_names[] = {
                                 "NEW",
                                 "READY",
                                 "RUNNING",
@@ -42,15 +53,174 @@ std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading
                                 "TERMINATED",
                                 "NOT_ASSIGNED"
     };
-    return (os << state_names[s]);
+    return state_names[s];
 }
+std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading the << operator to make printing of the enum easier
+    return (os << state_name(s));
+}
+
+//Buffered output file. Text and numbers (formatted with std::to_chars) go into one reusable buffer
+//that is flushed to the file whenever it fills up, so memory use does not grow with the trace length.
+struct output_sink {
+    std::FILE*          file = nullptr;
+    bool                owns_file = true;
+    std::string*        text = nullptr;     // Where flushes go instead of a file, see capture()
+    std::vector<char>   buffer = std::vector<char>(1 << 16);
+    std::size_t         used = 0;
+
+    output_sink() = default;
+    output_sink(const output_sink&) = delete;
+    output_sink& operator=(const output_sink&) = delete;
+    ~output_sink() { close(); }
+
+    //Creates (or empties) filename. Mode "w+b" also lets the file be read back, e.g. by append()
+    bool open(const char* filename, const char* mode = "wb") {
+        file = std::fopen(filename, mode);
+        return file != nullptr;
+    }
+
+    //Reopens a file written earlier to continue it at offset, dropping whatever came after
+    bool open_at(const char* filename, long offset) {
+        file = std::fopen(filename, "r+b");
+        if (!file || ftruncate(fileno(file), offset) != 0 || std::fseek(file, offset, SEEK_SET) != 0) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    //Bytes written so far, for a sink on a file that it wrote from the start
+    long position() {
+        flush();
+        return file ? std::ftell(file) : 0;
+    }
+
+    //Anonymous scratch file, for sections that are produced alongside but written after the main output
+    bool open_temporary() {
+        file = std::tmpfile();
+        return file != nullptr;
+    }
+
+    //Writes to a stream that is already open (e.g. stdout) and is left open by close()
+    void attach(std::FILE* stream) {
+        file = stream;
+        owns_file = false;
+    }
+
+    //Appends to a string instead of a file, for text that is formatted ahead of being written
+    void capture(std::string &target) {
+        text = &target;
+    }
+
+    void flush() {
+        if (used > 0) {
+            if (file) {
+                std::fwrite(buffer.data(), 1, used, file);
+            } else if (text) {
+                text->append(buffer.data(), used);
+            }
+        }
+        used = 0;
+    }
+
+    void close() {
+        if (text) {
+            flush();
+            text = nullptr;
+        }
+        if (file) {
+            flush();
+            if (owns_file) {
+                std::fclose(file);
+            } else {
+                std::fflush(file);
+            }
+            file = nullptr;
+        }
+    }
+
+    void write(const char* data, std::size_t length) {
+        if (used + length > buffer.size()) {
+            flush();
+            if (length > buffer.size()) {
+                if (file) {
+                    std::fwrite(data, 1, length, file);
+                } else if (text) {
+                    text->append(data, length);
+                }
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, length);
+        used += length;
+    }
+
+    //Writes text right aligned in a field of the given width, like std::setw
+    void write_right(const char* data, std::size_t length, std::size_t width) {
+        static const char spaces[] = "                                ";
+        while (length < width) {
+            std::size_t pad = std::min(width - length, sizeof(spaces) - 1);
+            write(spaces, pad);
+            width -= pad;
+        }
+        write(data, length);
+    }
+
+    void write_right(const char* text, std::size_t width) {
+        write_right(text, std::strlen(text), width);
+    }
+
+    template<typename Integer, typename = std::enable_if_t<std::is_integral<Integer>::value>>
+    void write_right(Integer value, std::size_t width) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        write_right(digits, result.ptr - digits, width);
+    }
+
+    //Copies everything written to another (temporary) sink to the end of this one
+    void append(output_sink& other) {
+        other.flush();
+        if (!other.file) {
+            return;
+        }
+        std::rewind(other.file);
+        char chunk[1 << 14];
+        std::size_t length;
+        while ((length = std::fread(chunk, 1, sizeof(chunk), other.file)) > 0) {
+            write(chunk, length);
+        }
+    }
+
+    output_sink& operator<<(const char* text) {
+        write(text, std::strlen(text));
+        return *this;
+    }
+
+    output_sink& operator<<(const std::string& text) {
+        write(text.data(), text.size());
+        return *this;
+    }
+
+    output_sink& operator<<(char c) {
+        write(&c, 1);
+        return *this;
+    }
+
+    template<typename Integer, typename = std::enable_if_t<std::is_integral<Integer>::value>>
+    output_sink& operator<<(Integer value) {
+        write_right(value, 0);
+        return *this;
+    }
+};
 
-// We have 100MB of memory partitions
 struct memory_partition{
     unsigned int    partition_number;
     unsigned int    size;
     int             occupied;
-} memory_paritions[] = {
+};
+
+// By default we have 100MB of memory partitions (a different table can be loaded with --partitions)
+const std::vector<memory_partition> default_partitions = {
     {1, 40, -1}, // 40MB
     {2, 25, -1}, // 25MB
     {3, 15, -1}, // 15MB
@@ -59,6 +229,8 @@ struct memory_partition{
     {6, 2, -1} // 2MB
 };
 
+// start_time, remaining_time, state and time_quantum_used are the initial values of a process. Once
+// it is admitted, its current values are in process_table::timers, not in its PCB.
 struct PCB{
     int             PID;
     unsigned int    size;
@@ -66,27 +238,375 @@ struct PCB{
     int             start_time;
     unsigned int    processing_time;   // How much CPU processing does the process need (based on time)
     unsigned int    remaining_time;      // CPU time remaining  (WAS UNSIGNED)
-    unsigned int    io_remaining_time; // I/O time remaining 
+    unsigned int    io_remaining_time; // I/O time remaining when the I/O started (the countdown lives in the wait queue)
     int             partition_number;
     enum states     state;
     unsigned int    io_freq;
     unsigned int    io_duration;
     unsigned int    priority;
     unsigned int    time_quantum_used;
+    unsigned int    ready_since;        // When the process last became READY
+    unsigned int    waiting_time;       // Total time spent READY, waiting for the CPU
+    int             first_run_time;     // When the process was first dispatched (-1 until then)
+    int             core;               // CPU whose ready queue the process goes back to (0 with one CPU)
+};
+
+// Every admitted PCB lives exactly once in the process table (job_list). The ready queue, the
+// wait queue and the CPU only hold handles, i.e. the PCB's slot index in that table.
+#define NO_PROCESS -1 // Handle held by an idle CPU
+
+//The fields of a PCB that change every time its process runs. The process table keeps them in an
+//array of their own, so the scheduling loop works on 16 byte records instead of whole PCBs.
+struct process_timers {
+    unsigned int    remaining_time;
+    unsigned int    time_quantum_used;
+    int             start_time;
+    enum states     state;
+};
+
+//The process table, split by how often the fields are touched: the timers of process i are hot[i]
+//and everything else is cold[i]. timers(i) is the only source of truth for them; the same fields in
+//cold[i] keep the values from admission and are never updated.
+struct process_table {
+    std::vector<PCB>            cold;
+    std::vector<process_timers> hot;
+
+    std::size_t size() const { return cold.size(); }
+    bool empty() const { return cold.empty(); }
+
+    //Adds a process, returning its handle
+    int add(const PCB &process) {
+        cold.push_back(process);
+        hot.push_back({process.remaining_time, process.time_quantum_used, process.start_time, process.state});
+        return cold.size() - 1;
+    }
+
+    PCB &operator[](int handle) { return cold[handle]; }
+    const PCB &operator[](int handle) const { return cold[handle]; }
+    process_timers &timers(int handle) { return hot[handle]; }
+    const process_timers &timers(int handle) const { return hot[handle]; }
+};
+
+//One process in the External Priorities ready queue
+struct ready_entry {
+    int                 PID;        // Priority of the process (lower PID = higher priority)
+    unsigned long long  sequence;   // Order in which it became ready, breaks ties between equal priorities FIFO
+    int                 handle;     // Slot of the process in job_list
+};
+
+//Binary min-heap of ready processes for the External Priorities schedulers, so dispatching the
+//highest priority process is O(log n) instead of re-sorting the whole ready queue every time
+struct priority_ready_queue {
+    std::vector<ready_entry>    entries;
+    unsigned long long          next_sequence = 0;
+
+    bool empty() const { return entries.empty(); }
+    std::size_t size() const { return entries.size(); }
+
+    void push(int handle, int PID) {
+        entries.push_back({PID, next_sequence++, handle});
+        std::push_heap(entries.begin(), entries.end(), runs_after);
+    }
+
+    //Removes and returns the handle of the highest priority process
+    int pop() {
+        std::pop_heap(entries.begin(), entries.end(), runs_after);
+        int handle = entries.back().handle;
+        entries.pop_back();
+        return handle;
+    }
+
+    //Heap ordering: true if first should be dispatched after second
+    static bool runs_after(const ready_entry &first, const ready_entry &second) {
+        if (first.PID != second.PID) {
+            return first.PID > second.PID;
+        }
+        return first.sequence > second.sequence;
+    }
+};
+
+//Growable ring buffer of ready processes for the Round Robin scheduler, so dispatching from the
+//front and requeueing at the back are O(1) without shifting the rest of the queue
+struct fifo_ready_queue {
+    std::vector<int>    slots = std::vector<int>(16); // Capacity is always a power of two
+    std::size_t         head = 0;
+    std::size_t         count = 0;
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    //Handle of the i-th process from the front
+    int at(std::size_t i) const {
+        return slots[(head + i) & (slots.size() - 1)];
+    }
+
+    void push(int handle) {
+        if (count == slots.size()) {
+            grow();
+        }
+        slots[(head + count) & (slots.size() - 1)] = handle;
+        count++;
+    }
+
+    //Removes and returns the handle at the front
+    int pop() {
+        int handle = slots[head];
+        head = (head + 1) & (slots.size() - 1);
+        count--;
+        return handle;
+    }
+
+    //Doubles the capacity and unwraps the queue to the start of the new buffer
+    void grow() {
+        std::vector<int> bigger(slots.size() * 2);
+        for (std::size_t i = 0; i < count; i++) {
+            bigger[i] = at(i);
+        }
+        slots.swap(bigger);
+        head = 0;
+    }
+};
+
+//One process in the I/O wait queue
+struct wait_entry {
+    unsigned int        completion_time;    // ms during which the process goes back to READY
+    unsigned long long  sequence;           // Order in which it started waiting, keeps simultaneous completions FIFO
+    int                 handle;             // Slot of the process in job_list
+};
+
+//Min-heap of waiting processes keyed by the ms their I/O completes, so each ms only touches the
+//processes that actually complete instead of counting down the I/O timer of every waiting process
+struct io_wait_queue {
+    std::vector<wait_entry>     entries;
+    unsigned long long          next_sequence = 0;
+
+    bool empty() const { return entries.empty(); }
+    std::size_t size() const { return entries.size(); }
+
+    void push(int handle, unsigned int completion_time) {
+        entries.push_back({completion_time, next_sequence++, handle});
+        std::push_heap(entries.begin(), entries.end(), completes_after);
+    }
+
+    //The earliest completion time in the queue, or NO_EVENT if nothing is waiting
+    unsigned int next_completion() const {
+        return entries.empty() ? NO_EVENT : entries.front().completion_time;
+    }
+
+    //Removes and returns the handle of the process that completes first
+    int pop() {
+        std::pop_heap(entries.begin(), entries.end(), completes_after);
+        int handle = entries.back().handle;
+        entries.pop_back();
+        return handle;
+    }
+
+    //Heap ordering: true if first leaves the wait queue after second
+    static bool completes_after(const wait_entry &first, const wait_entry &second) {
+        if (first.completion_time != second.completion_time) {
+            return first.completion_time > second.completion_time;
+        }
+        return first.sequence > second.sequence;
+    }
+};
+
+//------------------------------------BINARY TRANSITION TRACE-----------------------------------------
+// Optional compact alternative to the execution table (bin/interrupts_trace renders it back). A trace
+// file starts with TRACE_MAGIC and a table style byte, then holds one record per event:
+//   tag byte        bits 0-1 record kind, bits 2-4 old state, bits 5-7 new state (transitions only)
+//   varint          ms since the previous record
+//   transition:     zigzag varint PID
+//   partition:      varint partition number, zigzag varint PID now occupying it (-1 once freed)
+
+#define TRACE_MAGIC "ITRACE1" // 8 bytes including the terminating NUL
+
+enum trace_kind {
+    TRACE_TRANSITION,
+    TRACE_PARTITION
+};
+
+// Which table layout the simulator that wrote the trace uses
+enum table_style {
+    TABLE_BOXED,    // EP and RR: boxed header and footer
+    TABLE_EP_RR     // EP_RR: plain header, no footer
+};
+
+//One decoded trace record
+struct trace_entry {
+    trace_kind      kind;
+    unsigned int    time;
+    int             PID;
+    states          old_state;          // Transitions only
+    states          new_state;          // Transitions only
+    unsigned int    partition_number;   // Partition changes only
+};
+
+//Writes the binary trace. Every call is a no-op unless a file was opened, so simulators can always call it.
+struct trace_writer {
+    output_sink     output;
+    std::string     filename;
+    unsigned int    last_time = 0;
+
+    bool open(const char* trace_file, table_style style) {
+        if (!output.open(trace_file)) {
+            return false;
+        }
+        filename = trace_file;
+        output.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        output << static_cast<char>(style);
+        return true;
+    }
+
+    void write_varint(unsigned long long value) {
+        char bytes[10];
+        std::size_t length = 0;
+        while (value >= 0x80) {
+            bytes[length++] = static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        bytes[length++] = static_cast<char>(value);
+        output.write(bytes, length);
+    }
+
+    void write_zigzag(long long value) {
+        write_varint((static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63));
+    }
+
+    void transition(unsigned int time, int PID, states old_state, states new_state) {
+        if (!output.file) {
+            return;
+        }
+        output << static_cast<char>(TRACE_TRANSITION | (old_state << 2) | (new_state << 5));
+        write_varint(time - last_time);
+        write_zigzag(PID);
+        last_time = time;
+    }
+
+    //Records that a partition now holds PID, or was freed if PID is -1. Ignores processes without a partition.
+    void partition(unsigned int time, int partition_number, int PID) {
+        if (!output.file || partition_number < 0) {
+            return;
+        }
+        output << static_cast<char>(TRACE_PARTITION);
+        write_varint(time - last_time);
+        write_varint(partition_number);
+        write_zigzag(PID);
+        last_time = time;
+    }
+};
+
+//Reads a binary trace back one record at a time
+struct trace_reader {
+    std::FILE*          file = nullptr;
+    std::vector<char>   buffer = std::vector<char>(1 << 16);
+    std::size_t         used = 0;
+    std::size_t         position = 0;
+    unsigned int        time = 0;
+    table_style         style = TABLE_BOXED;
+
+    ~trace_reader() {
+        if (file) {
+            std::fclose(file);
+        }
+    }
+
+    //Opens the trace and reads its header, returning false if it is not a trace file
+    bool open(const char* filename) {
+        file = std::fopen(filename, "rb");
+        if (!file) {
+            return false;
+        }
+        char magic[sizeof(TRACE_MAGIC)];
+        int byte;
+        for (std::size_t i = 0; i < sizeof(magic); i++) {
+            if ((byte = next_byte()) < 0) {
+                return false;
+            }
+            magic[i] = static_cast<char>(byte);
+        }
+        if (std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 || (byte = next_byte()) < 0) {
+            return false;
+        }
+        style = static_cast<table_style>(byte);
+        return true;
+    }
+
+    //Next byte of the file, or -1 at the end
+    int next_byte() {
+        if (position == used) {
+            used = std::fread(buffer.data(), 1, buffer.size(), file);
+            position = 0;
+            if (used == 0) {
+                return -1;
+            }
+        }
+        return static_cast<unsigned char>(buffer[position++]);
+    }
+
+    bool read_varint(unsigned long long &value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int byte = next_byte();
+            if (byte < 0) {
+                return false;
+            }
+            value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool read_zigzag(long long &value) {
+        unsigned long long raw;
+        if (!read_varint(raw)) {
+            return false;
+        }
+        value = static_cast<long long>(raw >> 1) ^ -static_cast<long long>(raw & 1);
+        return true;
+    }
+
+    //Decodes the next record, returning false at the end of the trace (or on a truncated record)
+    bool next(trace_entry &entry) {
+        int tag = next_byte();
+        unsigned long long delta, number;
+        long long PID;
+        if (tag < 0 || !read_varint(delta)) {
+            return false;
+        }
+        time += delta;
+        entry.time = time;
+        entry.kind = static_cast<trace_kind>(tag & 0x3);
+        if (entry.kind == TRACE_TRANSITION) {
+            entry.old_state = static_cast<states>((tag >> 2) & 0x7);
+            entry.new_state = static_cast<states>((tag >> 5) & 0x7);
+            entry.partition_number = 0;
+        } else {
+            if (!read_varint(number)) {
+                return false;
+            }
+            entry.partition_number = number;
+        }
+        if (!read_zigzag(PID)) {
+            return false;
+        }
+        entry.PID = PID;
+        return true;
+    }
 };
 
 //------------------------------------HELPER FUNCTIONS FOR THE SIMULATOR------------------------------
-// Following function was taken from stackoverflow; helper function for splitting strings
-std::vector<std::string> split_delim(std::string input, std::string delim) {
+// Helper function for splitting strings (originally from stackoverflow, now scans forward instead of erasing the front)
+std::vector<std::string> split_delim(const std::string &input, const std::string &delim) {
     std::vector<std::string> tokens;
-    std::size_t pos = 0;
-    std::string token;
-    while ((pos = input.find(delim)) != std::string::npos) {
-        token = input.substr(0, pos);
-        tokens.push_back(token);
-        input.erase(0, pos + delim.length());
+    std::size_t start = 0;
+    std::size_t pos;
+    while ((pos = input.find(delim, start)) != std::string::npos) {
+        tokens.push_back(input.substr(start, pos - start));
+        start = pos + delim.length();
     }
-    tokens.push_back(input);
+    tokens.push_back(input.substr(start));
 
     return tokens;
 }
@@ -179,51 +699,85 @@ std::string print_exec_header() {
 
 }
 
-std::string print_exec_status(unsigned int current_time, int PID, states old_state, states new_state) {
+//Header of the execution log printed by EP_RR, which has no box around it
+std::string print_exec_header_EP_RR() {
+    return "Time    PID   OldState      NewState      Description\n"
+           "-----------------------------------------------------\n";
+}
 
+void print_exec_status(output_sink &output, unsigned int current_time, int PID, states old_state, states new_state) {
+    output << '|';
+    output.write_right(current_time, 18);
+    output << " |";
+    output.write_right(PID, 3);
+    output << " |";
+    output.write_right(state_name(old_state), 10);
+    output << " |";
+    output.write_right(state_name(new_state), 10);
+    output << " |\n";
+}
+
+std::string print_exec_footer() {
     const int tableWidth = 49;
+    std::stringstream buffer;
+
+    // Print bottom border
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+//Header of the execution table with more than one CPU, where every transition is tagged with its core
+std::string print_exec_header_cores() {
+
+    const int tableWidth = 55;
 
     std::stringstream buffer;
 
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
     buffer  << "|"
-            << std::setfill(' ') << std::setw(18) << current_time
+            << std::setfill(' ') << std::setw(18) << "Time of Transition"
             << std::setw(2) << "|"
-            << std::setw(3) << PID
+            << std::setfill(' ') << std::setw(4) << "Core"
             << std::setw(2) << "|"
-            << std::setw(10) << old_state
+            << std::setfill(' ') << std::setw(3) << "PID"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(10) << "Old State"
             << std::setw(2) << "|"
-            << std::setw(10) << new_state
+            << std::setfill(' ') << std::setw(10) << "New State"
             << std::setw(2) << "|" << std::endl;
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
 
     return buffer.str();
 }
 
-std::string print_exec_footer() {
-    const int tableWidth = 49;
+void print_exec_status(output_sink &output, unsigned int current_time, int core, int PID, states old_state, states new_state) {
+    output << '|';
+    output.write_right(current_time, 18);
+    output << " |";
+    output.write_right(core, 4);
+    output << " |";
+    output.write_right(PID, 3);
+    output << " |";
+    output.write_right(state_name(old_state), 10);
+    output << " |";
+    output.write_right(state_name(new_state), 10);
+    output << " |\n";
+}
+
+std::string print_exec_footer_cores() {
+    const int tableWidth = 55;
     std::stringstream buffer;
 
-    // Print bottom border
     buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
 
     return buffer.str();
 }
 
-//Synchronize the process in the process queue
-void sync_queue(std::vector<PCB> &process_queue, PCB _process) {
-    for(auto &process : process_queue) {
-        if(process.PID == _process.PID) {
-            process = _process;
-        }
-    }
-}
-
-//Writes a string to a file
-void write_output(std::string execution, const char* filename) {
-    std::ofstream output_file(filename);
-
-    if (output_file.is_open()) {
-        output_file << execution;
-        output_file.close();  // Close the file when done
+//Finishes the output file that the simulation has been streaming into
+void write_output(output_sink &output, const char* filename) {
+    if (output.file) {
+        output.close();  // Flush and close the file when done
         std::cout << "File content overwritten successfully." << std::endl;
     } else {
         std::cerr << "Error opening file!" << std::endl;
@@ -234,99 +788,495 @@ void write_output(std::string execution, const char* filename) {
 
 //--------------------------------------------FUNCTIONS FOR THE "OS"-------------------------------------
 
-//Assign memory partition to program
-bool assign_memory(PCB &program) {
-    int size_to_fit = program.size;
-    int available_size = 0;
+//The memory partitions, plus an index of the free ones ordered by size so that the best fit for a
+//process is found in O(log n), and a map from partition number to slot so freeing is O(1).
+//The totals shown in the memory logs are kept up to date as partitions change hands.
+struct partition_table {
+    std::vector<memory_partition>           partitions;
+    std::set<std::pair<unsigned int, int>>  free_by_size;   // (size, -slot): equal sizes go to the last slot first
+    std::unordered_map<unsigned int, int>   slot_of;        // partition_number -> slot in partitions
+    unsigned int                            total_used = 0;
+    unsigned int                            total_free = 0;
+    std::multiset<unsigned int>             starved;        // Sizes of the READY processes that never got a partition
+
+    std::size_t size() const { return partitions.size(); }
+    const memory_partition& operator[](std::size_t i) const { return partitions[i]; }
 
-    for(int i = 5; i >= 0; i--) {
-        available_size = memory_paritions[i].size;
+    //Replaces the table with the given layout, all partitions free
+    void load(const std::vector<memory_partition> &layout) {
+        partitions = layout;
+        free_by_size.clear();
+        slot_of.clear();
+        starved.clear();
+        total_used = 0;
+        total_free = 0;
+        for (int i = 0; i < (int) partitions.size(); i++) {
+            partitions[i].occupied = -1;
+            free_by_size.insert({partitions[i].size, -i});
+            slot_of[partitions[i].partition_number] = i;
+            total_free += partitions[i].size;
+        }
+    }
 
-        if(size_to_fit <= available_size && memory_paritions[i].occupied == -1) {
-            memory_paritions[i].occupied = program.PID;
-            program.partition_number = memory_paritions[i].partition_number;
-            return true;
+    //Gives the program the smallest free partition it fits in
+    bool assign(PCB &program) {
+        auto best = free_by_size.lower_bound({program.size, INT_MIN});
+        if (best == free_by_size.end()) {
+            return false;
         }
+
+        memory_partition &partition = partitions[-best->second];
+        free_by_size.erase(best);
+        partition.occupied = program.PID;
+        total_used += partition.size;
+        total_free -= partition.size;
+        program.partition_number = partition.partition_number;
+        return true;
     }
 
-    return false;
+    //Frees the partition recorded in the program's PCB
+    bool release(PCB &program) {
+        if (program.partition_number == -1) {
+            return false;
+        }
+
+        int slot = slot_of[program.partition_number];
+        partitions[slot].occupied = -1;
+        free_by_size.insert({partitions[slot].size, -slot});
+        total_used -= partitions[slot].size;
+        total_free += partitions[slot].size;
+        program.partition_number = -1;
+        return true;
+    }
+
+    //Puts back partitions saved by a checkpoint, along with the sizes of the processes waiting for memory
+    void restore(const std::vector<memory_partition> &saved, const std::vector<unsigned int> &starved_sizes) {
+        load(saved);
+        for (int i = 0; i < (int) partitions.size(); i++) {
+            if (saved[i].occupied != -1) {
+                free_by_size.erase({partitions[i].size, -i});
+                partitions[i].occupied = saved[i].occupied;
+                total_used += partitions[i].size;
+                total_free -= partitions[i].size;
+            }
+        }
+        starved.insert(starved_sizes.begin(), starved_sizes.end());
+    }
+
+    //Called as a process enters the ready queue: a READY process without a partition is waiting for memory
+    void enqueued(const PCB &process, states state) {
+        if (state == READY && process.partition_number == -1) {
+            starved.insert(process.size);
+        }
+    }
+
+    //Called as a process leaves the ready queue, before its state changes
+    void dequeued(const PCB &process, states state) {
+        if (state == READY && process.partition_number == -1) {
+            starved.erase(starved.find(process.size));
+        }
+    }
+
+    //Free memory in partitions big enough for the smallest process waiting for memory
+    unsigned int usable_memory() const {
+        if (starved.empty()) {
+            return total_free;
+        }
+
+        unsigned int usable = 0;
+        for (auto it = free_by_size.lower_bound({*starved.begin(), INT_MIN}); it != free_by_size.end(); ++it) {
+            usable += it->first;
+        }
+        return usable;
+    }
+};
+
+//Where and why an input file couldn't be parsed
+struct parse_error {
+    std::size_t     line = 0;
+    std::size_t     column = 0;
+    std::string     message;
+};
+
+//Parses all of text as a number that fits value, false for anything else (including spaces, a '+',
+//an empty string, or a '-' for an unsigned value)
+template<typename Number>
+bool parse_number(const std::string &text, Number &value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size();
 }
 
-//Free a memory partition
-bool free_memory(PCB &program){
-    for(int i = 5; i >= 0; i--) {
-        if(program.PID == memory_paritions[i].occupied) {
-            memory_paritions[i].occupied = -1;
-            program.partition_number = -1;
-            return true;
+//Parses the value of --stop-when: "idle" stops once every process admitted so far has terminated (what
+//the reference outputs do), "done" only once every input process has arrived and terminated
+bool parse_stop_rule(const std::string &text, bool &run_to_completion) {
+    if (text != "idle" && text != "done") {
+        return false;
+    }
+    run_to_completion = text == "done";
+    return true;
+}
+
+//Splits the line [line_start, line_end) into comma separated integers, with any spaces or tabs around
+//them, storing each one and where it starts. Returns how many there were (0 for a blank line), or -1
+//with the column and what is wrong in error.
+int parse_fields(const char* line_start, const char* line_end, long long* fields, const char** starts,
+                 int max_fields, parse_error &error) {
+    auto fail = [&](const char* at, const std::string &message) {
+        error.column = at - line_start + 1;
+        error.message = message;
+        return -1;
+    };
+    auto skip_blanks = [&](const char* at) {
+        while (at < line_end && (*at == ' ' || *at == '\t')) {
+            at++;
         }
+        return at;
+    };
+
+    const char* at = skip_blanks(line_start);
+    int count = 0;
+    while (at < line_end) {
+        if (count == max_fields) {
+            return fail(at, "expected at most " + std::to_string(max_fields) + " fields");
+        }
+        starts[count] = at;
+        auto result = std::from_chars(at, line_end, fields[count]);
+        if (result.ec == std::errc::result_out_of_range) {
+            return fail(at, "number out of range");
+        } else if (result.ec != std::errc()) {
+            return fail(at, "expected a number");
+        }
+        count++;
+
+        at = skip_blanks(result.ptr);
+        if (at == line_end) {
+            break;
+        } else if (*at != ',') {
+            return fail(at, "expected ','");
+        }
+        at = skip_blanks(at + 1);
+        if (at == line_end) {
+            return fail(at, "expected a number");
+        }
+    }
+    return count;
+}
+
+//Reads a partition table, one "partition_number, size" line per partition, split like the process
+//list. Returns false if the file can't be opened, or with where the table isn't valid in error.
+bool load_partitions(const char* filename, std::vector<memory_partition> &layout, parse_error &error) {
+    layout.clear();
+    std::ifstream input_file(filename);
+    if (!input_file.is_open()) {
+        error.message = "unable to open file";
+        return false;
+    }
+
+    // Partition numbers have to be unique since processes free their partition by number
+    std::set<unsigned int> numbers;
+    std::string line;
+    for (std::size_t line_number = 1; std::getline(input_file, line); line_number++) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        const char* line_end = line.data() + line.size();
+        auto fail = [&](const char* at, const char* message) {
+            error.line = line_number;
+            error.column = at - line.data() + 1;
+            error.message = message;
+            return false;
+        };
+
+        long long fields[2];
+        const char* starts[2];
+        int count = parse_fields(line.data(), line_end, fields, starts, 2, error);
+        if (count < 0) {
+            error.line = line_number;
+            return false;
+        } else if (count == 0) {
+            continue;
+        } else if (count < 2) {
+            return fail(line_end, "expected \"partition_number, size\"");
+        }
+        for (int i = 0; i < count; i++) {
+            if (fields[i] < 0 || fields[i] > UINT_MAX) {
+                return fail(starts[i], "number out of range");
+            }
+        }
+
+        memory_partition partition = {(unsigned int) fields[0], (unsigned int) fields[1], -1};
+        if (partition.size == 0) {
+            return fail(starts[1], "partition size has to be positive");
+        } else if (!numbers.insert(partition.partition_number).second) {
+            return fail(starts[0], "duplicate partition number");
+        }
+        layout.push_back(partition);
+    }
+    if (layout.empty()) {
+        error.message = "no partitions";
+        return false;
+    }
+    return true;
+}
+
+//Options given after the input file
+struct simulator_options {
+    const char* trace_file = nullptr;       // --trace <file>
+    const char* partition_file = nullptr;   // --partitions <file>
+    const char* policy = nullptr;           // --policy <EP|RR|EP_RR>
+    unsigned int time_quantum = TIME_QUANTUM; // --quantum <ms>
+    const char* metrics_file = nullptr;     // --metrics <file>
+    unsigned int cores = 1;                 // --cores <n>
+    unsigned int threads = 1;               // --threads <n>
+    const char* checkpoint_file = nullptr;  // --checkpoint <file>
+    unsigned int checkpoint_at = NO_EVENT;  // --checkpoint-at <ms>
+    unsigned int checkpoint_every = 0;      // --checkpoint-every <ms>
+    bool run_to_completion = false;         // --stop-when <idle|done>
+};
+
+//Parses the "--option <value>" pairs after the input file. Prints the first option it doesn't know
+//or whose value is invalid, and returns false.
+bool parse_options(int argc, char** argv, simulator_options &options) {
+    // Every option takes a value
+    for (int i = 2; i < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        bool valid = i + 1 < argc;
+        if (!valid) {
+            // Missing value
+        } else if (option == "--trace") {
+            options.trace_file = argv[i + 1];
+        } else if (option == "--partitions") {
+            options.partition_file = argv[i + 1];
+        } else if (option == "--policy") {
+            options.policy = argv[i + 1];
+        } else if (option == "--metrics") {
+            options.metrics_file = argv[i + 1];
+        } else if (option == "--quantum") {
+            valid = parse_number(value, options.time_quantum) && options.time_quantum > 0;
+        } else if (option == "--cores") {
+            valid = parse_number(value, options.cores) && options.cores > 0;
+        } else if (option == "--threads") {
+            valid = parse_number(value, options.threads) && options.threads > 0;
+        } else if (option == "--checkpoint") {
+            options.checkpoint_file = argv[i + 1];
+        } else if (option == "--checkpoint-at") {
+            valid = parse_number(value, options.checkpoint_at);
+        } else if (option == "--checkpoint-every") {
+            valid = parse_number(value, options.checkpoint_every) && options.checkpoint_every > 0;
+        } else if (option == "--stop-when") {
+            valid = parse_stop_rule(value, options.run_to_completion);
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            std::cout << "ERROR!\nInvalid option: " << option << " " << value << std::endl;
+            return false;
+        }
+    }
+
+    // A checkpoint needs both where to save it and when
+    bool checkpoint_time = options.checkpoint_at != NO_EVENT || options.checkpoint_every > 0;
+    if (checkpoint_time != (options.checkpoint_file != nullptr)) {
+        std::cout << "ERROR!\n--checkpoint <file> goes with --checkpoint-at <ms> or --checkpoint-every <ms>" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//Reads the partition layout from the --partitions file, or uses the default table without one
+bool setup_partitions(const simulator_options &options, std::vector<memory_partition> &layout) {
+    if (!options.partition_file) {
+        layout = default_partitions;
+        return true;
+    }
+
+    parse_error error;
+    if (!load_partitions(options.partition_file, layout, error)) {
+        std::cerr << "Error: Unable to read partition table: " << options.partition_file;
+        if (error.line > 0) {
+            std::cerr << ":" << error.line << ":" << error.column;
+        }
+        std::cerr << ": " << error.message << std::endl;
+        return false;
     }
-    return false;
+    return true;
+}
+
+//Assign memory partition to program
+bool assign_memory(partition_table &memory, PCB &program) {
+    return memory.assign(program);
 }
 
-//Convert a list of strings into a PCB
-PCB add_process(std::vector<std::string> tokens) {
+//Free a memory partition
+bool free_memory(partition_table &memory, PCB &program){
+    return memory.release(program);
+}
+
+//Initial PCB of a process from the input file
+PCB new_process(int PID, unsigned int size, unsigned int arrival_time, unsigned int processing_time,
+                unsigned int io_freq, unsigned int io_duration, unsigned int priority) {
     PCB process;
-    process.PID = std::stoi(tokens[0]);
-    process.size = std::stoi(tokens[1]);
-    process.arrival_time = std::stoi(tokens[2]);
-    process.processing_time = std::stoi(tokens[3]);
-    process.remaining_time = std::stoi(tokens[3]);
+    process.PID = PID;
+    process.size = size;
+    process.arrival_time = arrival_time;
+    process.processing_time = processing_time;
+    process.remaining_time = processing_time;
     process.io_remaining_time = 0;
-    process.io_freq = std::stoi(tokens[4]);
-    process.io_duration = std::stoi(tokens[5]);
+    process.io_freq = io_freq;
+    process.io_duration = io_duration;
     process.start_time = -1;
     process.partition_number = -1;
     process.state = NOT_ASSIGNED;
-    process.priority = process.PID; // Newly added for priority based algorithms. All are initially set based off their PID
+    process.priority = priority; // The schedulers still prioritize by PID, the priority column is only informational
     process.time_quantum_used = 0; // Newly added for algorithms involving round robin
+    process.ready_since = 0;
+    process.waiting_time = 0;
+    process.first_run_time = -1;
+    process.core = 0;
 
     return process;
 }
 
-//Returns true if all processes in the queue have terminated
-bool all_process_terminated(std::vector<PCB> processes) {
+//Read-only view of a whole input file. Regular files are memory mapped so they are parsed in
+//place; anything that can't be mapped (e.g. a pipe) is read into memory instead.
+struct mapped_file {
+    const char*     data = nullptr;
+    std::size_t     size = 0;
+    void*           mapping = MAP_FAILED;
+    std::string     contents;   // Only used when the file couldn't be mapped
 
-    for(auto process : processes) {
-        if(process.state != TERMINATED) {
+    mapped_file() = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file() {
+        if (mapping != MAP_FAILED) {
+            munmap(mapping, size);
+        }
+    }
+
+    bool open(const char* filename) {
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0) {
             return false;
         }
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                size = info.st_size;
+                data = static_cast<const char*>(mapping);
+                ::close(fd);
+                return true;
+            }
+        }
+
+        char chunk[1 << 16];
+        ssize_t length;
+        while ((length = ::read(fd, chunk, sizeof(chunk))) > 0) {
+            contents.append(chunk, length);
+        }
+        ::close(fd);
+        data = contents.data();
+        size = contents.size();
+        return length == 0;
+    }
+};
+
+//Parses the process list in [data, data + size) in place. Every line holds "PID, size, arrival
+//time, CPU time, I/O frequency, I/O duration" and optionally a priority, as comma separated
+//integers with any spaces or tabs around them. The CPU time has to be positive, a process with none
+//would never terminate. Blank lines are skipped.
+bool parse_processes(const char* data, std::size_t size, std::vector<PCB> &list_process, parse_error &error) {
+    const char* end = data + size;
+    list_process.reserve(list_process.size() + std::count(data, end, '\n') + 1);
+
+    const char* line_start = data;
+    for (std::size_t line = 1; line_start < end; line++) {
+        const char* line_end = static_cast<const char*>(std::memchr(line_start, '\n', end - line_start));
+        if (!line_end) {
+            line_end = end;
+        }
+        const char* next_line = line_end < end ? line_end + 1 : end;
+        if (line_end > line_start && line_end[-1] == '\r') {
+            line_end--;
+        }
+
+        auto fail = [&](const char* at, const char* message) {
+            error.line = line;
+            error.column = at - line_start + 1;
+            error.message = message;
+            return false;
+        };
+
+        long long fields[7];
+        const char* starts[7];  // Where each field is, for errors about its value
+        int count = parse_fields(line_start, line_end, fields, starts, 7, error);
+        if (count < 0) {
+            error.line = line;
+            return false;
+        } else if (count == 0) {
+            line_start = next_line;
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            if (fields[i] > (i == 0 ? INT_MAX : UINT_MAX) || fields[i] < (i == 0 ? INT_MIN : 0)) {
+                return fail(starts[i], "number out of range");
+            }
+        }
+
+        if (count < 6) {
+            return fail(line_end, "expected at least 6 fields");
+        } else if (fields[3] == 0) {
+            return fail(starts[3], "CPU time has to be positive");
+        }
+
+        // Without a priority column, the priority is the PID (lower PID = higher priority)
+        list_process.push_back(new_process(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5],
+                                           count == 7 ? fields[6] : fields[0]));
+        line_start = next_line;
     }
 
     return true;
 }
 
-//Terminates a given process
-void terminate_process(PCB &running, std::vector<PCB> &job_queue) {
-    running.remaining_time = 0;
-    running.state = TERMINATED;
-    free_memory(running);
-    sync_queue(job_queue, running);
+//Returns true if all processes in the table have terminated, given how many terminate_process has counted
+bool all_process_terminated(const process_table &processes, std::size_t terminated_count) {
+    return terminated_count == processes.size();
+}
+
+//Sorts the processes by arrival time so they can be admitted through a cursor (ties keep their input order)
+void sort_by_arrival(std::vector<PCB> &processes) {
+    std::stable_sort(
+        processes.begin(),
+        processes.end(),
+        [](const PCB &first, const PCB &second) {
+            return first.arrival_time < second.arrival_time;
+        }
+    );
+}
+
+//Returns the arrival time of the process at the admission cursor, or NO_EVENT if nothing else arrives
+unsigned int next_arrival_time(const std::vector<PCB> &list_processes, std::size_t next_arrival) {
+    if(next_arrival < list_processes.size()) {
+        return list_processes[next_arrival].arrival_time;
+    }
+
+    return NO_EVENT;
 }
 
-//set the process in the ready queue to runnning
-void run_process(PCB &running, std::vector<PCB> &job_queue, std::vector<PCB> &ready_queue, unsigned int current_time) {
-    running = ready_queue.back();
-    ready_queue.pop_back();
-    running.start_time = current_time;
-    running.state = RUNNING;
-    sync_queue(job_queue, running);
+//Terminates a given process and counts it towards all_process_terminated
+void terminate_process(process_table &processes, int handle, partition_table &memory, std::size_t &terminated_count) {
+    processes.timers(handle).remaining_time = 0;
+    processes.timers(handle).state = TERMINATED;
+    free_memory(memory, processes[handle]);
+    terminated_count++;
 }
 
-void idle_CPU(PCB &running) {
-    running.start_time = 0;
-    running.processing_time = 0;
-    running.remaining_time = 0;
-    running.io_remaining_time = 0;
-    running.arrival_time = 0;
-    running.io_duration = 0;
-    running.io_freq = 0;
-    running.partition_number = 0;
-    running.size = 0;
-    running.state = NOT_ASSIGNED;
-    running.PID = -1;
-    running.priority = -1;
-    running.time_quantum_used = 0;
+void idle_CPU(int &running) {
+    running = NO_PROCESS;
 }
 
 #endif
\ No newline at end of file
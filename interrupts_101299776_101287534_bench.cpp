@@ -0,0 +1,283 @@
+/**
+ * @file interrupts_101299776_101287534_bench.cpp
+ * @brief Measures how fast the simulator itself runs: every policy over generated workloads of
+ *        increasing size and time horizon, with the results also written as CSV so runs can be
+ *        compared against each other
+ *
+ */
+
+#include "interrupts_101299776_101287534_engine.hpp"
+#include "interrupts_101299776_101287534_workload.hpp"
+#include <chrono>
+#include <map>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+
+// One benchmark case: a policy over a generated workload
+struct bench_case {
+    std::string         policy;
+    unsigned long long  processes;
+    double              scale;      // Factor on every time in the workload, i.e. how long its horizon is
+};
+
+// What a case measured. Passed from the child process that ran it through a pipe.
+struct bench_result {
+    bool                ok = false;
+    unsigned int        simulated_ms = 0;
+    unsigned long long  transitions = 0;
+    double              wall_seconds = 0;
+    long                peak_rss_kb = 0;
+};
+
+std::vector<std::string> split_list(const std::string &list) {
+    return split_delim(list, ",");
+}
+
+//Runs one case once, in a child process so that its peak memory is measured on its own
+bench_result run_case(const bench_case &test, unsigned long long seed, bool write_logs, unsigned int threads) {
+    int channel[2];
+    if (pipe(channel) != 0) {
+        return {};
+    }
+
+    pid_t child = fork();
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return {};
+    }
+
+    if (child == 0) {
+        close(channel[0]);
+        bench_result result;
+
+        workload load;
+        load.processes = test.processes;
+        load.seed = seed;
+        load.scale_times(test.scale);
+        std::vector<PCB> list_process;
+        list_process.reserve(test.processes);
+        bool complete = generate_workload(load, [&](const PCB &process) { list_process.push_back(process); });
+
+        if (complete) {
+            simulation_settings settings;
+            settings.print_loaded = false;
+            settings.write_logs = write_logs;
+            settings.threads = threads;
+            settings.run_to_completion = true; // Otherwise the first idle gap would end the run
+
+            // The output is formatted as usual but thrown away, so disk speed doesn't count
+            output_sink exec;
+            if (write_logs) {
+                exec.open("/dev/null");
+            }
+            trace_writer no_trace;
+
+            auto start = std::chrono::steady_clock::now();
+            schedule_metrics metrics;
+            with_policy(test.policy, [&](auto policy_type) {
+                metrics = run_simulation<decltype(policy_type)>(std::move(list_process), settings, exec, no_trace);
+            });
+            exec.close();
+            result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            result.ok = true;
+            result.simulated_ms = metrics.finish_time;
+            result.transitions = metrics.transitions;
+            result.peak_rss_kb = usage.ru_maxrss;
+        }
+
+        ssize_t written = write(channel[1], &result, sizeof(result));
+        close(channel[1]);
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    bench_result result;
+    if (read(channel[0], &result, sizeof(result)) != sizeof(result)) {
+        result.ok = false;
+    }
+    close(channel[0]);
+    waitpid(child, nullptr, 0);
+    return result;
+}
+
+//Reads the wall time of every case in an earlier CSV, keyed by "policy,processes,scale". Returns false
+//if the file can't be opened, or names the line and field that isn't valid.
+bool load_baseline(const char* filename, std::map<std::string, double> &baseline) {
+    std::ifstream input(filename);
+    if (!input.is_open()) {
+        std::cerr << "Error: Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(input, line); // Header
+    for (std::size_t line_number = 2; std::getline(input, line); line_number++) {
+        if (line.empty()) {
+            continue;
+        }
+        auto fields = split_list(line);
+        double wall_seconds = 0;
+        if (fields.size() < 7) {
+            std::cerr << "Error: " << filename << ":" << line_number << ": expected at least 7 fields, up to wall_seconds"
+                      << std::endl;
+            return false;
+        } else if (!parse_number(fields[6], wall_seconds)) {
+            std::cerr << "Error: " << filename << ":" << line_number << ": wall_seconds is not a number: " << fields[6]
+                      << std::endl;
+            return false;
+        }
+        baseline[fields[0] + "," + fields[1] + "," + fields[2]] = wall_seconds;
+    }
+    return true;
+}
+
+void print_usage() {
+    std::cout << "To benchmark, do: ./interrupts_bench [options]" << std::endl;
+    std::cout << "  --policies <list>    policies to run (default EP,RR,EP_RR)" << std::endl;
+    std::cout << "  --sizes <list>       process counts (default 1000,10000,100000)" << std::endl;
+    std::cout << "  --scales <list>      factors on every time in the workload, for longer horizons (default 1,4)" << std::endl;
+    std::cout << "  --repeat <n>         runs per case, the fastest one is reported (default 3)" << std::endl;
+    std::cout << "  --seed <n>           workload seed (default 1)" << std::endl;
+    std::cout << "  --no-logs            don't format the execution and memory logs, to time the scheduling alone" << std::endl;
+    std::cout << "  --threads <n>        host threads per simulation, the ones beyond the first format the logs (default 1)" << std::endl;
+    std::cout << "  --out <file>         CSV results (default bench_results.csv)" << std::endl;
+    std::cout << "  --baseline <file>    CSV of an earlier run to compare the wall times against" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> policies = {external_priorities::name, round_robin::name, external_priorities_rr::name};
+    std::vector<unsigned long long> sizes = {1000, 10000, 100000};
+    std::vector<double> scales = {1, 4};
+    unsigned int repeat = 3;
+    unsigned long long seed = 1;
+    bool write_logs = true;
+    unsigned int threads = 1;
+    std::string out_file = "bench_results.csv";
+    const char* baseline_file = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool valid = true;
+        if (option == "--no-logs") {
+            write_logs = false;
+        } else if (i + 1 < argc && option == "--policies") {
+            policies = split_list(argv[++i]);
+        } else if (i + 1 < argc && option == "--sizes") {
+            sizes.clear();
+            for (const auto &size : split_list(argv[++i])) {
+                sizes.push_back(0);
+                valid = valid && parse_number(size, sizes.back()) && sizes.back() > 0;
+            }
+        } else if (i + 1 < argc && option == "--scales") {
+            scales.clear();
+            for (const auto &scale : split_list(argv[++i])) {
+                scales.push_back(0);
+                valid = valid && parse_number(scale, scales.back()) && scales.back() > 0 && std::isfinite(scales.back());
+            }
+        } else if (i + 1 < argc && option == "--repeat") {
+            valid = parse_number(argv[++i], repeat) && repeat > 0;
+        } else if (i + 1 < argc && option == "--threads") {
+            valid = parse_number(argv[++i], threads) && threads > 0;
+        } else if (i + 1 < argc && option == "--seed") {
+            valid = parse_number(argv[++i], seed);
+        } else if (i + 1 < argc && option == "--out") {
+            out_file = argv[++i];
+        } else if (i + 1 < argc && option == "--baseline") {
+            baseline_file = argv[++i];
+        } else {
+            std::cout << "ERROR!\nUnknown option: " << option << std::endl;
+            print_usage();
+            return -1;
+        }
+
+        if (!valid) {
+            std::cout << "ERROR!\nInvalid option: " << option << " " << argv[i] << std::endl;
+            print_usage();
+            return -1;
+        }
+    }
+
+    std::vector<bench_case> cases;
+    for (const auto &policy : policies) {
+        if (!with_policy(policy, [](auto) {})) {
+            std::cout << "ERROR!\nUnknown policy: " << policy << std::endl;
+            return -1;
+        }
+        for (auto processes : sizes) {
+            for (double scale : scales) {
+                cases.push_back({policy, processes, scale});
+            }
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (baseline_file && !load_baseline(baseline_file, baseline)) {
+        return -1;
+    }
+
+    std::ofstream csv(out_file);
+    if (!csv.is_open()) {
+        std::cerr << "Error: Unable to open file: " << out_file << std::endl;
+        return -1;
+    }
+    csv << "policy,processes,scale,seed,logs,simulated_ms,wall_seconds,simulated_ms_per_second,"
+           "transitions,transitions_per_second,peak_rss_kb" << std::endl;
+
+    std::cout << std::left << std::setw(7) << "Policy" << std::right
+              << std::setw(10) << "Processes" << std::setw(7) << "Scale"
+              << std::setw(13) << "Sim ms" << std::setw(10) << "Wall s"
+              << std::setw(14) << "Sim ms/s" << std::setw(14) << "Trans/s"
+              << std::setw(12) << "Peak KB"
+              << (baseline_file ? "   vs baseline" : "") << std::endl;
+
+    int status = 0;
+    for (const auto &test : cases) {
+        // Keep the fastest run, the others only saw more noise
+        bench_result best;
+        for (unsigned int run = 0; run < repeat; run++) {
+            bench_result result = run_case(test, seed, write_logs, threads);
+            if (result.ok && (!best.ok || result.wall_seconds < best.wall_seconds)) {
+                best = result;
+            }
+        }
+
+        std::ostringstream scale_text;
+        scale_text << test.scale;
+        if (!best.ok) {
+            std::cerr << "Error: " << test.policy << " with " << test.processes << " processes at scale "
+                      << scale_text.str() << " failed" << std::endl;
+            status = -1;
+            continue;
+        }
+
+        double wall = std::max(best.wall_seconds, 1e-9);
+        double ms_per_second = best.simulated_ms / wall;
+        double transitions_per_second = best.transitions / wall;
+
+        csv << test.policy << "," << test.processes << "," << scale_text.str() << "," << seed << ","
+            << (write_logs ? "on" : "off") << "," << best.simulated_ms << "," << std::setprecision(9)
+            << best.wall_seconds << "," << std::setprecision(6) << ms_per_second << "," << best.transitions << ","
+            << transitions_per_second << "," << best.peak_rss_kb << std::endl;
+
+        std::cout << std::left << std::setw(7) << test.policy << std::right
+                  << std::setw(10) << test.processes << std::setw(7) << scale_text.str()
+                  << std::setw(13) << best.simulated_ms
+                  << std::fixed << std::setprecision(4) << std::setw(10) << best.wall_seconds
+                  << std::setprecision(0) << std::setw(14) << ms_per_second << std::setw(14) << transitions_per_second
+                  << std::setw(12) << best.peak_rss_kb;
+
+        auto previous = baseline.find(test.policy + "," + std::to_string(test.processes) + "," + scale_text.str());
+        if (previous != baseline.end() && previous->second > 0) {
+            std::cout << std::showpos << std::setprecision(1) << std::setw(13)
+                      << (best.wall_seconds / previous->second - 1) * 100 << "%" << std::noshowpos;
+        }
+        std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+
+    std::cout << "Results written to " << out_file << std::endl;
+    return status;
+}
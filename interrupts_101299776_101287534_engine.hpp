@@ -0,0 +1,1755 @@
+/**
+ * @file interrupts_101299776_101287534_engine.hpp
+ * @brief Simulation engine shared by every scheduler. The engine is a template on a scheduling
+ *        policy, so each policy's hooks are inlined into the main loop instead of being virtual calls.
+ *
+ */
+
+#ifndef INTERRUPTS_ENGINE_HPP_
+#define INTERRUPTS_ENGINE_HPP_
+
+#include "interrupts_101299776_101287534.hpp"
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#ifdef INTERRUPTS_PROFILE
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+
+//------------------------------------------SCHEDULING POLICIES------------------------------------------
+// A policy provides:
+//   ready_queue                         the ready queue type
+//   name                                what --policy selects it with
+//   file_prefix                         prefix of its output files in batch mode (as in output_files/)
+//   style                               the output layout of the binary that used to implement it
+//   time_sliced                         whether a process is preempted when its time quantum runs out
+//   preempt_on_arrival                  whether an arriving process preempts a lower priority one
+//   enqueue(queue, handle, process)     puts a process into the ready queue
+//   pick_next(queue)                    removes the process to dispatch from the ready queue
+//   io_clock(process, timers, current_time) CPU time that counts towards the next I/O request once
+//                                       the current ms has run (should_request_io checks it)
+//   io_completion(process, current_time) ms at which an I/O started now leaves the wait queue
+
+// External Priorities scheduler - processes are prioritized by PID (lower PID = higher priority)
+// The ready queue is a heap ordered that way, so the next process to run is simply its top
+int ExternalPriorities(priority_ready_queue &ready_queue) {
+    return ready_queue.pop();
+}
+
+// First come first served - the ready queue is a FIFO ring buffer, so the next process to run is its front
+int FCFS(fifo_ready_queue &ready_queue) {
+    return ready_queue.pop();
+}
+
+// Check if a process should request I/O based on its frequency
+bool should_request_io(const PCB &process, unsigned int time_ran) {
+    // If the CPU time counted towards I/O is a multiple of the set i/o frequency, request I/O for that process
+    return (process.io_freq > 0 && time_ran > 0 && time_ran % process.io_freq == 0);
+}
+
+// External Priorities without preemption. I/O is requested every io_freq ms since the last dispatch.
+struct external_priorities {
+    using ready_queue = priority_ready_queue;
+    static constexpr const char*    name = "EP";
+    static constexpr const char*    file_prefix = "EP";
+    static constexpr table_style    style = TABLE_BOXED;
+    static constexpr bool           time_sliced = false;
+    static constexpr bool           preempt_on_arrival = false;
+
+    static void enqueue(ready_queue &queue, int handle, const PCB &process) { queue.push(handle, process.PID); }
+    static int pick_next(ready_queue &queue) { return ExternalPriorities(queue); }
+
+    static unsigned int io_clock(const PCB &, const process_timers &timers, unsigned int current_time) {
+        return (current_time + 1) - timers.start_time;
+    }
+
+    // The I/O timer reaches 0 io_duration ms from now (a zero duration never counts down)
+    static unsigned int io_completion(const PCB &process, unsigned int current_time) {
+        return process.io_duration > 0 ? current_time + process.io_duration : NO_EVENT;
+    }
+};
+
+// Round Robin with a time slice of --quantum ms (TIME_QUANTUM by default). I/O is requested the same way as in EP.
+struct round_robin {
+    using ready_queue = fifo_ready_queue;
+    static constexpr const char*    name = "RR";
+    static constexpr const char*    file_prefix = "RR";
+    static constexpr table_style    style = TABLE_BOXED;
+    static constexpr bool           time_sliced = true;
+    static constexpr bool           preempt_on_arrival = false;
+
+    static void enqueue(ready_queue &queue, int handle, const PCB &) { queue.push(handle); }
+    static int pick_next(ready_queue &queue) { return FCFS(queue); }
+
+    static unsigned int io_clock(const PCB &process, const process_timers &timers, unsigned int current_time) {
+        return external_priorities::io_clock(process, timers, current_time);
+    }
+
+    static unsigned int io_completion(const PCB &process, unsigned int current_time) {
+        return external_priorities::io_completion(process, current_time);
+    }
+};
+
+// External Priorities with preemption on arrival and a Round Robin time slice. I/O is requested
+// based on TOTAL CPU time used so far, and the process leaves the wait queue the ms after its I/O
+// timer reaches 0.
+struct external_priorities_rr {
+    using ready_queue = priority_ready_queue;
+    static constexpr const char*    name = "EP_RR";
+    static constexpr const char*    file_prefix = "EPRR";
+    static constexpr table_style    style = TABLE_EP_RR;
+    static constexpr bool           time_sliced = true;
+    static constexpr bool           preempt_on_arrival = true;
+
+    static void enqueue(ready_queue &queue, int handle, const PCB &process) { queue.push(handle, process.PID); }
+    static int pick_next(ready_queue &queue) { return ExternalPriorities(queue); }
+
+    static unsigned int io_clock(const PCB &process, const process_timers &timers, unsigned int) {
+        return process.processing_time - timers.remaining_time + 1;
+    }
+
+    static unsigned int io_completion(const PCB &process, unsigned int current_time) {
+        return current_time + process.io_duration + 1;
+    }
+};
+
+
+//----------------------------------------------THE ENGINE-----------------------------------------------
+
+//Everything about a run besides the processes themselves
+struct simulation_settings {
+    std::vector<memory_partition>   layout = default_partitions;
+    unsigned int                    time_quantum = TIME_QUANTUM;
+    bool                            print_loaded = true;    // Print the processes to stdout before running them
+    bool                            write_logs = true;      // Write the execution table and the memory analysis
+    bool                            run_to_completion = false; // Run until every input process arrived and terminated,
+                                                            // instead of stopping once the admitted ones have
+    unsigned int                    cores = 1;              // Simulated CPUs, each with its own ready queue
+    unsigned int                    threads = 1;            // Host threads, the ones beyond the first format the logs
+    const char*                     checkpoint_file = nullptr; // Where to save checkpoints, if anywhere
+    unsigned int                    checkpoint_at = NO_EVENT;  // First ms to save a checkpoint at
+    unsigned int                    checkpoint_every = 0;      // ms between checkpoints after that (0 for just one)
+};
+
+//Histogram of times in constant memory, for percentiles without keeping every sample. Values below
+//128 get a bucket each; larger values share a bucket with the values that have the same top 7 bits,
+//so a percentile is off by at most 1/128 of its value.
+struct streaming_histogram {
+    static constexpr int        EXACT = 128;
+    static constexpr int        HALF = EXACT / 2;
+    static constexpr int        BUCKETS = EXACT + (32 - 7) * HALF;
+
+    std::vector<unsigned long long> counts = std::vector<unsigned long long>(BUCKETS);
+    unsigned long long          count = 0;
+    unsigned int                min = UINT_MAX;
+    unsigned int                max = 0;
+
+    static int bucket(unsigned int value) {
+        if (value < EXACT) {
+            return value;
+        }
+        int shift = (31 - __builtin_clz(value)) - 6;
+        return EXACT + (shift - 1) * HALF + ((value >> shift) - HALF);
+    }
+
+    //Smallest value in a bucket, and how many values it covers
+    static std::pair<unsigned long long, unsigned long long> range(int index) {
+        if (index < EXACT) {
+            return {index, 1};
+        }
+        int shift = (index - EXACT) / HALF + 1;
+        unsigned long long top = (index - EXACT) % HALF + HALF;
+        return {top << shift, 1ULL << shift};
+    }
+
+    void add(unsigned int value) {
+        counts[bucket(value)]++;
+        count++;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    //Value below which the given fraction of the samples lie (the middle of its bucket)
+    unsigned int percentile(double fraction) const {
+        if (count == 0) {
+            return 0;
+        }
+
+        unsigned long long rank = std::max(1ULL, (unsigned long long) std::ceil(fraction * count));
+        unsigned long long seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                auto [low, width] = range(i);
+                unsigned long long middle = low + (width - 1) / 2;
+                return std::min<unsigned long long>(std::max<unsigned long long>(middle, min), max);
+            }
+        }
+        return max;
+    }
+};
+
+//Scheduling metrics over the processes that terminated, computed as they terminate, plus how
+//much the simulation did
+struct schedule_metrics {
+    unsigned int        finish_time = 0;        // Simulated ms when the simulation ended
+    unsigned long long  transitions = 0;        // State transitions logged
+    std::size_t         completed = 0;
+    unsigned long long  total_turnaround = 0;   // Termination - arrival
+    unsigned long long  total_waiting = 0;      // Time spent READY, waiting for the CPU
+    unsigned long long  total_response = 0;     // First dispatch - arrival
+    unsigned int        cores = 1;
+    unsigned long long  busy_time = 0;          // CPU ms spent running processes, summed over the cores
+    unsigned long long  steals = 0;             // Processes an idle core took from another core's ready queue
+    std::size_t         stranded = 0;           // Admitted processes the run stopped without terminating
+    std::size_t         never_admitted = 0;     // Input processes that had not arrived when the run stopped
+    streaming_histogram turnaround;
+    streaming_histogram waiting;
+    streaming_histogram response;
+
+    void add(const PCB &process, unsigned int termination_time) {
+        unsigned int process_turnaround = termination_time - process.arrival_time;
+        unsigned int process_response = process.first_run_time - process.arrival_time;
+
+        completed++;
+        total_turnaround += process_turnaround;
+        total_waiting += process.waiting_time;
+        total_response += process_response;
+        turnaround.add(process_turnaround);
+        waiting.add(process.waiting_time);
+        response.add(process_response);
+    }
+
+    double average(unsigned long long total) const {
+        return completed == 0 ? 0.0 : (double) total / completed;
+    }
+
+    //Processes completed per 1000 simulated ms
+    double throughput() const {
+        return finish_time == 0 ? 0.0 : completed * 1000.0 / finish_time;
+    }
+
+    //Share of the available CPU time that was spent running processes
+    double utilization() const {
+        return finish_time == 0 ? 0.0 : (double) busy_time / ((double) finish_time * cores);
+    }
+};
+
+//Human readable summary of the metrics of a run
+std::string print_metrics(const schedule_metrics &metrics) {
+    std::stringstream buffer;
+    buffer << "=== SCHEDULING METRICS ===" << std::endl;
+    buffer << "Completed processes: " << metrics.completed << std::endl;
+    if (metrics.never_admitted > 0) {
+        buffer << "Never arrived: " << metrics.never_admitted << (metrics.never_admitted == 1 ? " input process" : " input processes")
+               << ", not in any of the numbers below" << std::endl;
+    }
+    buffer << "Simulated time: " << metrics.finish_time << " ms" << std::endl;
+    buffer << std::fixed << std::setprecision(2);
+    buffer << "Throughput: " << metrics.throughput() << " processes per 1000 ms" << std::endl;
+    buffer << "CPU utilization: " << metrics.utilization() * 100 << "% of " << metrics.cores
+           << (metrics.cores == 1 ? " core" : " cores");
+    if (metrics.cores > 1) {
+        buffer << ", " << metrics.steals << " work steals";
+    }
+    buffer << std::endl;
+    buffer << std::left << std::setw(12) << "Metric" << std::right << std::setw(12) << "Mean" << std::setw(10) << "p50"
+           << std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10) << "Max" << std::endl;
+
+    auto row = [&](const char* name, unsigned long long total, const streaming_histogram &histogram) {
+        buffer << std::left << std::setw(12) << name << std::right << std::setw(12) << metrics.average(total)
+               << std::setw(10) << histogram.percentile(0.50) << std::setw(10) << histogram.percentile(0.95)
+               << std::setw(10) << histogram.percentile(0.99) << std::setw(10) << histogram.max << std::endl;
+    };
+    row("Turnaround", metrics.total_turnaround, metrics.turnaround);
+    row("Waiting", metrics.total_waiting, metrics.waiting);
+    row("Response", metrics.total_response, metrics.response);
+
+    return buffer.str();
+}
+
+//-------------------------------------------HOT PATH PROFILE--------------------------------------------
+// Built with -DINTERRUPTS_PROFILE, every simulation times each phase of its main loop, counts the
+// ready queue operations, PCB copies and queue lengths, and prints a profile report to stderr when it
+// finishes. Without it the PROFILE_ macros expand to nothing, so the main loop is exactly as before.
+// Phases nest (e.g. admitting a process logs its transition and the memory), and the time of a nested
+// phase only counts towards that phase, not towards the one around it.
+
+#ifdef INTERRUPTS_PROFILE
+
+//Cycle counter where the CPU has one, nanoseconds elsewhere
+inline unsigned long long profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Phases of the main loop, in the order they run each ms
+enum profile_phase {ADMIT, SCHEDULE, WAIT_QUEUE, EXECUTE, LOG_TRANSITIONS, LOG_MEMORY, SKIP_AHEAD, CHECKPOINT, PHASES};
+
+struct profile_scope;
+
+struct hot_path_profile {
+    profile_scope*      active = nullptr;   // Innermost phase being timed
+    unsigned long long  calls[PHASES] = {};
+    unsigned long long  ticks[PHASES] = {};
+    unsigned long long  iterations = 0;     // Passes through the main loop, i.e. ms not skipped
+    unsigned long long  enqueues = 0;       // Processes put into a ready queue
+    unsigned long long  picks = 0;          // Processes taken off a ready queue to run
+    unsigned long long  wait_pushes = 0;    // Processes put into the wait queue
+    unsigned long long  pcb_copies = 0;     // Whole PCBs copied, i.e. processes admitted into the process table
+    unsigned long long  ready_total = 0;    // Ready processes summed over the iterations, for the mean
+    std::size_t         ready_peak = 0;
+    unsigned long long  waiting_total = 0;  // Same for the wait queue
+    std::size_t         waiting_peak = 0;
+
+    void sample(std::size_t ready, std::size_t waiting) {
+        iterations++;
+        ready_total += ready;
+        ready_peak = std::max(ready_peak, ready);
+        waiting_total += waiting;
+        waiting_peak = std::max(waiting_peak, waiting);
+    }
+};
+
+//Times one phase from its construction to the end of its scope, less the phases nested in it
+struct profile_scope {
+    hot_path_profile    &profile;
+    profile_phase       phase;
+    profile_scope*      outer;
+    unsigned long long  start;
+    unsigned long long  nested = 0;     // Ticks of the phases timed inside this one
+
+    profile_scope(hot_path_profile &profile, profile_phase phase)
+        : profile(profile), phase(phase), outer(profile.active), start(profile_ticks()) {
+        profile.active = this;
+    }
+    ~profile_scope() {
+        unsigned long long elapsed = profile_ticks() - start;
+        profile.calls[phase]++;
+        profile.ticks[phase] += elapsed - nested;
+        if (outer) {
+            outer->nested += elapsed;
+        }
+        profile.active = outer;
+    }
+};
+
+//Profile report of a run under the named policy
+std::string print_profile(const hot_path_profile &profile, const char* policy) {
+    const char* phase_names[PHASES] = {"Admit", "Schedule", "Wait queue", "Execute", "Log transitions",
+                                       "Log memory", "Skip ahead", "Checkpoint"};
+    unsigned long long total = 0;
+    for (unsigned long long ticks : profile.ticks) {
+        total += ticks;
+    }
+
+    std::stringstream buffer;
+    buffer << "=== HOT PATH PROFILE (" << policy << ") ===" << std::endl;
+#if defined(__x86_64__) || defined(__i386__)
+    const char* unit = "Cycles";
+#else
+    const char* unit = "ns";
+#endif
+    buffer << std::left << std::setw(17) << "Phase" << std::right << std::setw(12) << "Calls" << std::setw(16) << unit
+           << std::setw(12) << "Per call" << std::setw(9) << "Share" << std::endl;
+    buffer << std::fixed << std::setprecision(1);
+    for (int phase = 0; phase < PHASES; phase++) {
+        buffer << std::left << std::setw(17) << phase_names[phase] << std::right << std::setw(12) << profile.calls[phase]
+               << std::setw(16) << profile.ticks[phase]
+               << std::setw(12) << (profile.calls[phase] == 0 ? 0.0 : (double) profile.ticks[phase] / profile.calls[phase])
+               << std::setw(8) << (total == 0 ? 0.0 : profile.ticks[phase] * 100.0 / total) << "%" << std::endl;
+    }
+
+    double iterations = std::max(1ULL, profile.iterations);
+    buffer << "Loop iterations: " << profile.iterations << std::endl;
+    buffer << "Ready queue: " << profile.enqueues << " enqueues, " << profile.picks << " picks, mean length "
+           << profile.ready_total / iterations << ", peak " << profile.ready_peak << std::endl;
+    buffer << "Wait queue: " << profile.wait_pushes << " pushes, mean length "
+           << profile.waiting_total / iterations << ", peak " << profile.waiting_peak << std::endl;
+    buffer << "PCB copies: " << profile.pcb_copies << std::endl;
+    return buffer.str();
+}
+
+#define PROFILE_PHASE(phase) profile_scope phase_scope(profile, phase)
+#define PROFILE_COUNT(counter) profile.counter++
+#define PROFILE_SAMPLE(ready, waiting) profile.sample(ready, waiting)
+#else
+#define PROFILE_PHASE(phase)
+#define PROFILE_COUNT(counter)
+#define PROFILE_SAMPLE(ready, waiting)
+#endif
+
+//------------------------------------------PARALLEL LOG FORMATTING--------------------------------------
+// Formatting the execution table and the memory log takes far longer than the scheduling itself, so
+// with --threads the simulation only records what to log and a pool of threads formats it. Batches
+// are written in the order they were recorded, so the files come out exactly as without threads.
+
+//One postponed log entry
+struct log_command {
+    bool            memory;         // A run of memory logs instead of a transition
+    unsigned int    first_time;     // Time of the transition, or first ms of the memory logs
+    unsigned int    last_time;      // Last ms of the memory logs, which all show the same snapshot
+    int             core;           // Transitions only, -1 when cores are not shown
+    int             PID;
+    states          old_state;
+    states          new_state;
+    std::size_t     offset;         // Memory logs only: where the snapshot is in the batch's snapshots
+    std::size_t     length;
+};
+
+//Log entries recorded by the simulation, and their text once a thread has formatted them
+struct log_batch {
+    enum stage { RECORDING, QUEUED, FORMATTING, FORMATTED };
+
+    std::vector<log_command>    commands;
+    std::string                 snapshots;
+    std::size_t                 lines = 0;
+    stage                       status = RECORDING;
+    std::string                 execution_text;
+    std::string                 memory_text;
+
+    void clear() {
+        commands.clear();
+        snapshots.clear();
+        lines = 0;
+        status = RECORDING;
+        execution_text.clear();
+        memory_text.clear();
+    }
+
+    void format() {
+        output_sink execution, memory;
+        execution.capture(execution_text);
+        memory.capture(memory_text);
+        for (const auto &command : commands) {
+            if (command.memory) {
+                for (unsigned long long time = command.first_time; time <= command.last_time; time++) {
+                    memory << "Time: " << time << " - ";
+                    memory.write(snapshots.data() + command.offset, command.length);
+                }
+            } else if (command.core >= 0) {
+                print_exec_status(execution, command.first_time, command.core, command.PID, command.old_state, command.new_state);
+            } else {
+                print_exec_status(execution, command.first_time, command.PID, command.old_state, command.new_state);
+            }
+        }
+        execution.close();
+        memory.close();
+    }
+};
+
+//Formats the logs of one simulation on a pool of threads and writes them in order
+struct log_pipeline {
+    static constexpr std::size_t    LINES_PER_BATCH = 8192;
+
+    output_sink                             &execution_status;
+    output_sink                             &memory_status;
+    std::vector<std::thread>                workers;
+    std::mutex                              lock;
+    std::condition_variable                 changed;
+    std::deque<std::unique_ptr<log_batch>>  batches;        // Submitted and not yet written, in order
+    std::vector<std::unique_ptr<log_batch>> spare;          // Written batches, reused to avoid allocating
+    std::unique_ptr<log_batch>              recording;      // Batch the simulation is adding to
+    std::size_t                             max_batches;    // Submitted batches before the simulation waits
+    bool                                    writing = false;
+    bool                                    stopping = false;
+
+    log_pipeline(output_sink &execution_status, output_sink &memory_status, unsigned int threads)
+        : execution_status(execution_status), memory_status(memory_status),
+          recording(std::make_unique<log_batch>()), max_batches(4 * threads) {
+        for (unsigned int i = 0; i < threads; i++) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~log_pipeline() {
+        finish();
+    }
+
+    void transition(unsigned int time, int core, int PID, states old_state, states new_state) {
+        recording->commands.push_back({false, time, time, core, PID, old_state, new_state, 0, 0});
+        if (++recording->lines >= LINES_PER_BATCH) {
+            submit();
+        }
+    }
+
+    //The same memory snapshot logged at every ms from first_time to last_time
+    void memory(unsigned int first_time, unsigned int last_time, const std::string &snapshot) {
+        unsigned long long first = first_time;
+        while (first <= last_time) {
+            // Split long runs so no batch holds much more than LINES_PER_BATCH lines of text
+            unsigned long long room = LINES_PER_BATCH - std::min(recording->lines, LINES_PER_BATCH - 1);
+            unsigned long long last = std::min<unsigned long long>(last_time, first + room - 1);
+
+            std::size_t offset = recording->snapshots.size();
+            recording->snapshots += snapshot;
+            recording->commands.push_back({true, (unsigned int) first, (unsigned int) last, -1, 0, NOT_ASSIGNED,
+                                           NOT_ASSIGNED, offset, snapshot.size()});
+            recording->lines += last - first + 1;
+            if (recording->lines >= LINES_PER_BATCH) {
+                submit();
+            }
+            first = last + 1;
+        }
+    }
+
+    //Queues the recorded batch for formatting and starts a new one
+    void submit() {
+        if (recording->commands.empty()) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard, [this]() { return batches.size() < max_batches; });
+        recording->status = log_batch::QUEUED;
+        batches.push_back(std::move(recording));
+        if (spare.empty()) {
+            recording = std::make_unique<log_batch>();
+        } else {
+            recording = std::move(spare.back());
+            spare.pop_back();
+        }
+        changed.notify_all();
+    }
+
+    //Waits until everything recorded so far is written
+    void flush() {
+        submit();
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard, [this]() { return batches.empty() && !writing; });
+    }
+
+    //Writes everything that was recorded and stops the threads
+    void finish() {
+        if (workers.empty()) {
+            return;
+        }
+        submit();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        changed.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            auto queued = std::find_if(batches.begin(), batches.end(), [](const std::unique_ptr<log_batch> &batch) {
+                return batch->status == log_batch::QUEUED;
+            });
+            if (queued == batches.end()) {
+                if (stopping) {
+                    return;
+                }
+                changed.wait(guard);
+                continue;
+            }
+
+            log_batch &batch = **queued;
+            batch.status = log_batch::FORMATTING;
+            guard.unlock();
+            batch.format();
+            guard.lock();
+            batch.status = log_batch::FORMATTED;
+
+            // Whoever finds the oldest batch formatted writes it, and every formatted one after it
+            while (!writing && !batches.empty() && batches.front()->status == log_batch::FORMATTED) {
+                std::unique_ptr<log_batch> done = std::move(batches.front());
+                batches.pop_front();
+                writing = true;
+                guard.unlock();
+                execution_status << done->execution_text;
+                memory_status << done->memory_text;
+                done->clear();
+                guard.lock();
+                writing = false;
+                spare.push_back(std::move(done));
+                changed.notify_all();
+            }
+        }
+    }
+};
+
+
+//-----------------------------------------------CHECKPOINTS-----------------------------------------------
+// A checkpoint holds the whole state of a simulation at the start of a ms: the settings it runs
+// with, where its output files were, every queue and table and the metrics so far. The memory log
+// (which is only written into execution.txt at the end) is streamed into <checkpoint>.memory next to
+// it, so like execution.txt and the trace only its length is saved. Values are stored as they are in
+// memory, so a checkpoint is read back on the same kind of machine that wrote it.
+
+#define CHECKPOINT_MAGIC "ICHKPT2" // 8 bytes including the terminating NUL
+
+struct checkpoint_writer {
+    output_sink     output;
+
+    template<typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as they are");
+        output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    void put(const std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are written as they are");
+        put<unsigned long long>(values.size());
+        output.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void put(const std::string &text) {
+        put<unsigned long long>(text.size());
+        output.write(text.data(), text.size());
+    }
+};
+
+//Reads a checkpoint back. Every get leaves ok false once the file ends early.
+struct checkpoint_reader {
+    std::FILE*  file = nullptr;
+    bool        ok = true;
+
+    ~checkpoint_reader() {
+        if (file) {
+            std::fclose(file);
+        }
+    }
+
+    bool open(const char* filename) {
+        file = std::fopen(filename, "rb");
+        char magic[sizeof(CHECKPOINT_MAGIC)];
+        ok = file && std::fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+             && std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0;
+        return ok;
+    }
+
+    void read(void* data, std::size_t length) {
+        ok = ok && std::fread(data, 1, length, file) == length;
+    }
+
+    template<typename T>
+    void get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are read as they are");
+        read(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void get(std::vector<T> &values) {
+        unsigned long long size = 0;
+        get(size);
+        values.resize(ok ? size : 0);
+        read(values.data(), values.size() * sizeof(T));
+    }
+
+    void get(std::string &text) {
+        unsigned long long size = 0;
+        get(size);
+        text.resize(ok ? size : 0);
+        read(text.data(), text.size());
+    }
+};
+
+//What a checkpoint says about the run it was taken from, read before the simulation itself
+struct checkpoint_header {
+    std::string     policy;
+    unsigned int    time_quantum = TIME_QUANTUM;
+    unsigned int    cores = 1;
+    bool            run_to_completion = false;
+    long            execution_offset = 0;   // Bytes of execution.txt written before the checkpoint
+    std::string     trace_file;             // Empty without a trace
+    long            trace_offset = 0;
+    unsigned int    trace_time = 0;         // Time of the last trace record, which the next one is relative to
+    std::string     memory_file;            // Empty without the logs
+    long            memory_offset = 0;
+
+    void save(checkpoint_writer &out) const {
+        out.put(policy);
+        out.put(time_quantum);
+        out.put(cores);
+        out.put(run_to_completion);
+        out.put(execution_offset);
+        out.put(trace_file);
+        out.put(trace_offset);
+        out.put(trace_time);
+        out.put(memory_file);
+        out.put(memory_offset);
+    }
+
+    bool load(checkpoint_reader &in) {
+        in.get(policy);
+        in.get(time_quantum);
+        in.get(cores);
+        in.get(run_to_completion);
+        in.get(execution_offset);
+        in.get(trace_file);
+        in.get(trace_offset);
+        in.get(trace_time);
+        in.get(memory_file);
+        in.get(memory_offset);
+        return in.ok && time_quantum > 0 && cores > 0;
+    }
+};
+
+void save_queue(checkpoint_writer &out, const priority_ready_queue &queue) {
+    out.put(queue.entries);
+    out.put(queue.next_sequence);
+}
+
+void load_queue(checkpoint_reader &in, priority_ready_queue &queue) {
+    in.get(queue.entries);
+    in.get(queue.next_sequence);
+}
+
+//The ring buffer is saved front to back, so it comes back unwrapped
+void save_queue(checkpoint_writer &out, const fifo_ready_queue &queue) {
+    std::vector<int> handles(queue.size());
+    for (std::size_t i = 0; i < handles.size(); i++) {
+        handles[i] = queue.at(i);
+    }
+    out.put(handles);
+}
+
+void load_queue(checkpoint_reader &in, fifo_ready_queue &queue) {
+    std::vector<int> handles;
+    in.get(handles);
+    queue = fifo_ready_queue();
+    for (int handle : handles) {
+        queue.push(handle);
+    }
+}
+
+void save_queue(checkpoint_writer &out, const io_wait_queue &queue) {
+    out.put(queue.entries);
+    out.put(queue.next_sequence);
+}
+
+void load_queue(checkpoint_reader &in, io_wait_queue &queue) {
+    in.get(queue.entries);
+    in.get(queue.next_sequence);
+}
+
+//Histograms are saved as their non-empty buckets, most of them are empty
+void save_histogram(checkpoint_writer &out, const streaming_histogram &histogram) {
+    std::vector<int> indexes;
+    std::vector<unsigned long long> counts;
+    for (int i = 0; i < streaming_histogram::BUCKETS; i++) {
+        if (histogram.counts[i] > 0) {
+            indexes.push_back(i);
+            counts.push_back(histogram.counts[i]);
+        }
+    }
+    out.put(indexes);
+    out.put(counts);
+    out.put(histogram.count);
+    out.put(histogram.min);
+    out.put(histogram.max);
+}
+
+void load_histogram(checkpoint_reader &in, streaming_histogram &histogram) {
+    std::vector<int> indexes;
+    std::vector<unsigned long long> counts;
+    in.get(indexes);
+    in.get(counts);
+    in.ok = in.ok && indexes.size() == counts.size();
+    for (std::size_t i = 0; in.ok && i < indexes.size(); i++) {
+        in.ok = indexes[i] >= 0 && indexes[i] < streaming_histogram::BUCKETS;
+        if (in.ok) {
+            histogram.counts[indexes[i]] = counts[i];
+        }
+    }
+    in.get(histogram.count);
+    in.get(histogram.min);
+    in.get(histogram.max);
+}
+
+
+//One simulated CPU: the process on it and the processes queued for it
+template<typename Policy>
+struct cpu_core {
+    typename Policy::ready_queue    ready_queue;    // Handles into job_list
+    int                             running = NO_PROCESS; // Handle of the process on this CPU
+    bool                            cpu_idle = true;
+};
+
+template<typename Policy>
+struct simulation {
+    std::vector<PCB>                list_processes; // Every process in the input, sorted by arrival time
+    std::size_t                     next_arrival = 0; // Index in list_processes of the next process to arrive
+
+    std::vector<cpu_core<Policy>>   cores;          // The CPUs, each with its own ready queue
+    std::size_t                     ready_count = 0; // Processes in all the ready queues together
+    io_wait_queue                   wait_queue;     // The wait queue of processes (handles into job_list, by completion time)
+    process_table                   job_list;       // The process table that owns every admitted process
+
+    unsigned int                    current_time = 0;
+    std::size_t                     terminated_count = 0; // How many processes in job_list have terminated
+    partition_table                 memory_paritions; // Memory of this simulation, so simulations can run in parallel
+    unsigned int                    time_quantum;
+    bool                            print_loaded;
+    bool                            write_logs;
+    bool                            run_to_completion;
+    unsigned int                    threads;
+    schedule_metrics                metrics;
+#ifdef INTERRUPTS_PROFILE
+    hot_path_profile                profile;        // Where the main loop spends its time
+#endif
+
+    const char*                     checkpoint_file;
+    unsigned int                    checkpoint_at;
+    unsigned int                    checkpoint_every;
+    unsigned int                    next_checkpoint; // ms at which the next checkpoint is saved
+    bool                            checkpoint_saved = false; // At least one checkpoint was written this run
+    bool                            resumed = false; // Continues a run restored from a checkpoint or forked off
+                                                     // another simulation, so the output has been started
+    bool                            finished = false; // The main loop is done for good
+
+    // Transitions postponed to the end of each ms (PID, old state, new state, core), reused across
+    // iterations to avoid allocating
+    std::vector<std::tuple<int, states, states, int>> transitions;
+
+    output_sink                     &execution_status;
+    trace_writer                    &trace;
+
+    // For bonus mark - memory analysis. It is written after the execution table, so it is
+    // streamed into a scratch file until the table is done, or into memory_file when checkpointing
+    output_sink                     memory_status;
+    std::string                     memory_file;
+    std::string                     snapshot;       // Reused for formatting each memory log entry
+    std::unique_ptr<log_pipeline>   pipeline;       // Formats the logs on other threads, if there are any
+
+    simulation(std::vector<PCB> processes, const simulation_settings &settings,
+               output_sink &execution_status, trace_writer &trace)
+        : list_processes(std::move(processes)), cores(std::max(1u, settings.cores)), time_quantum(settings.time_quantum),
+          print_loaded(settings.print_loaded), write_logs(settings.write_logs), run_to_completion(settings.run_to_completion),
+          threads(std::max(1u, settings.threads)), checkpoint_file(settings.checkpoint_file),
+          checkpoint_at(settings.checkpoint_at), checkpoint_every(settings.checkpoint_every),
+          execution_status(execution_status), trace(trace) {
+        schedule_checkpoint();
+        memory_paritions.load(settings.layout);
+        metrics.cores = cores.size();
+    }
+
+    //Sets the first checkpoint: at --checkpoint-at, or a period after the current ms (which is where a
+    //restored run continues from) with --checkpoint-every
+    void schedule_checkpoint() {
+        next_checkpoint = NO_EVENT;
+        if (checkpoint_file && checkpoint_at != NO_EVENT) {
+            next_checkpoint = checkpoint_at;
+        } else if (checkpoint_file && checkpoint_every > 0) {
+            next_checkpoint = current_time + checkpoint_every;
+        }
+    }
+
+    bool multi_core() const {
+        return cores.size() > 1;
+    }
+
+    // Memory status without its "Time: " prefix, since it stays the same across ms where nothing changes state.
+    // Overwrites snapshot, leaving it empty if nothing is active.
+    void memory_snapshot() {
+        snapshot.clear();
+        bool all_idle = true;
+        for (const auto &core : cores) {
+            all_idle = all_idle && core.cpu_idle;
+        }
+        if (all_idle && ready_count == 0 && wait_queue.empty()) {
+            return;
+        }
+
+        if (!multi_core()) {
+            snapshot += "Running: " + (cores[0].cpu_idle ? "IDLE" : "PID " + std::to_string(job_list[cores[0].running].PID));
+        } else {
+            // One entry per core, e.g. "Running: [PID 3, IDLE]"
+            snapshot += "Running: [";
+            for (std::size_t i = 0; i < cores.size(); i++) {
+                snapshot += (cores[i].cpu_idle ? "IDLE" : "PID " + std::to_string(job_list[cores[i].running].PID));
+                snapshot += (i + 1 < cores.size() ? ", " : "]");
+            }
+        }
+        snapshot += ", Ready: " + std::to_string(ready_count);
+        snapshot += ", Waiting: " + std::to_string(wait_queue.size()) + "\n";
+
+        // Memory usage, kept up to date by the partition table as partitions and the ready queue change
+        snapshot += "  Memory - Used: " + std::to_string(memory_paritions.total_used) + "MB, ";
+        snapshot += "Free: " + std::to_string(memory_paritions.total_free) + "MB, ";
+        snapshot += "Usable: " + std::to_string(memory_paritions.usable_memory()) + "MB\n";
+
+        // Show partition status
+        if (Policy::style == TABLE_BOXED) {
+            snapshot += "  Partitions: ";
+            for (std::size_t i = 0; i < memory_paritions.size(); i++) {
+                snapshot += "P" + std::to_string(memory_paritions[i].partition_number) + ":";
+                if (memory_paritions[i].occupied == -1) {
+                    snapshot += "free";
+                } else {
+                    snapshot += "PID" + std::to_string(memory_paritions[i].occupied);
+                }
+                snapshot += (i + 1 < memory_paritions.size() ? ", " : "");
+            }
+            snapshot += "\n\n";
+        } else {
+            snapshot += "  Partitions:\n";
+            for (std::size_t i = 0; i < memory_paritions.size(); i++) {
+                snapshot += "    [" + std::to_string(i) + "] Size: " + std::to_string(memory_paritions[i].size) + "MB, ";
+                if (memory_paritions[i].occupied == -1) {
+                    snapshot += "Free\n";
+                } else {
+                    snapshot += "Occupied by PID " + std::to_string(memory_paritions[i].occupied) + "\n";
+                }
+            }
+        }
+    }
+
+    // Function to log memory status
+    void log_memory_status() {
+        if (!write_logs) {
+            return;
+        }
+        PROFILE_PHASE(LOG_MEMORY);
+        memory_snapshot();
+        if (!snapshot.empty()) {
+            if (pipeline) {
+                pipeline->memory(current_time, current_time, snapshot);
+            } else {
+                memory_status << "Time: " << current_time << " - " << snapshot;
+            }
+        }
+    }
+
+    //Logs a transition, tagged with the core it happened on when there is more than one
+    void log_transition(unsigned int time, int core, int PID, states old_state, states new_state) {
+        PROFILE_PHASE(LOG_TRANSITIONS);
+        metrics.transitions++;
+        if (pipeline) {
+            pipeline->transition(time, multi_core() ? core : -1, PID, old_state, new_state);
+        } else if (write_logs) {
+            if (multi_core()) {
+                print_exec_status(execution_status, time, core, PID, old_state, new_state);
+            } else {
+                print_exec_status(execution_status, time, PID, old_state, new_state);
+            }
+        }
+        trace.transition(time, PID, old_state, new_state);
+    }
+
+    //Puts a process into the ready queue of its core, READY as of ready_time
+    void make_ready(int handle, unsigned int ready_time) {
+        PCB &process = job_list[handle];
+        process.ready_since = ready_time;
+        Policy::enqueue(cores[process.core].ready_queue, handle, process);
+        PROFILE_COUNT(enqueues);
+        ready_count++;
+        memory_paritions.enqueued(process, job_list.timers(handle).state);
+    }
+
+    //Frees a CPU, e.g. after the running process terminated, blocked or was preempted
+    void release_CPU(cpu_core<Policy> &core) {
+        idle_CPU(core.running);
+        core.cpu_idle = true;
+    }
+
+    //Core an arriving process is queued on: the one with the least work, the lowest numbered on a tie
+    int place(const PCB &) const {
+        int best = 0;
+        std::size_t best_load = SIZE_MAX;
+        for (std::size_t i = 0; i < cores.size() && best_load > 0; i++) {
+            std::size_t load = cores[i].ready_queue.size() + (cores[i].cpu_idle ? 0 : 1);
+            if (load < best_load) {
+                best = i;
+                best_load = load;
+            }
+        }
+        return best;
+    }
+
+    //  === 1. ADMIT NEW PROCESSES THAT HAVE ARRIVED ===
+    void admit_arrivals() {
+        //Take every process whose arrival time has been reached off the front of the sorted list
+        while (next_arrival < list_processes.size() && list_processes[next_arrival].arrival_time <= current_time) {
+            const PCB &process = list_processes[next_arrival++];
+
+            //Add it to the process table, assign memory and put it into the ready queue of a core
+            int handle = job_list.add(process);
+            PROFILE_COUNT(pcb_copies);
+            assign_memory(memory_paritions, job_list[handle]);
+            trace.partition(current_time, job_list[handle].partition_number, process.PID);
+
+            int core_number = multi_core() ? place(process) : 0;
+            cpu_core<Policy> &core = cores[core_number];
+            job_list[handle].core = core_number;
+            job_list.timers(handle).state = READY;  //Set the process state to READY
+            make_ready(handle, current_time);
+
+            log_transition(current_time, core_number, process.PID, NEW, READY);
+            log_memory_status(); // Process state transition indicates memory log
+
+            // Preempt if new process has higher priority (smaller PID) AND its CPU is busy. The preempted
+            // process keeps its RUNNING state until it is dispatched again.
+            if (Policy::preempt_on_arrival && !core.cpu_idle && process.PID < job_list[core.running].PID) {
+                log_transition(current_time, core_number, job_list[core.running].PID, RUNNING, READY);
+                make_ready(core.running, current_time);
+                release_CPU(core);
+            }
+        }
+    }
+
+    //Puts a process taken off a ready queue on an idle core
+    void run_on(int core_number, int handle) {
+        cpu_core<Policy> &core = cores[core_number];
+        core.running = handle;
+        ready_count--;
+        PROFILE_COUNT(picks);
+
+        PCB &process = job_list[handle];
+        process_timers &timers = job_list.timers(handle);
+        memory_paritions.dequeued(process, timers.state);
+        process.core = core_number;
+        timers.state = RUNNING;
+        timers.start_time = current_time;   // This now means "last run start time"
+        timers.time_quantum_used = 0;       // Start counting to the time quantum
+        process.waiting_time += current_time - process.ready_since;
+        if (process.first_run_time == -1) {
+            process.first_run_time = current_time;
+        }
+
+        core.cpu_idle = false;
+        log_transition(current_time, core_number, process.PID, READY, RUNNING);
+        log_memory_status(); // Process state transition indicates memory log
+    }
+
+    //Core with the longest ready queue, or -1 if every ready queue is empty
+    int steal_victim() const {
+        int victim = -1;
+        std::size_t longest = 0;
+        for (std::size_t i = 0; i < cores.size(); i++) {
+            if (cores[i].ready_queue.size() > longest) {
+                victim = i;
+                longest = cores[i].ready_queue.size();
+            }
+        }
+        return victim;
+    }
+
+    // === 2. SCHEDULE A PROCESS FROM THE READY QUEUE ===
+    void dispatch() {
+        // Only find a new process to run if there are any processes in the ready queues
+        if (ready_count == 0) {
+            return;
+        }
+
+        // Every idle CPU runs the next process of its own ready queue
+        for (std::size_t i = 0; i < cores.size(); i++) {
+            if (cores[i].cpu_idle && !cores[i].ready_queue.empty()) {
+                run_on(i, Policy::pick_next(cores[i].ready_queue));
+            }
+        }
+
+        // ...and the CPUs that are still idle steal the process the busiest ready queue would run next
+        for (std::size_t i = 0; i < cores.size() && ready_count > 0; i++) {
+            if (cores[i].cpu_idle) {
+                run_on(i, Policy::pick_next(cores[steal_victim()].ready_queue));
+                metrics.steals++;
+            }
+        }
+    }
+
+    // == 3. UPDATE WAIT QUEUE ==
+    void complete_io() {
+        // Move the processes whose I/O completes during this ms back to the ready queue of their core
+        // The wait queue is ordered by completion time, so only those processes are touched
+        while (wait_queue.next_completion() <= current_time) {
+            int handle = wait_queue.pop();
+            PCB &process = job_list[handle];
+            process.io_remaining_time = 0;
+            job_list.timers(handle).state = READY;
+            make_ready(handle, current_time + 1); // READY as of when the transition is logged
+            transitions.push_back({process.PID, WAITING, READY, process.core});
+        }
+    }
+
+    // == 4. EXECUTE RUNNING PROCESSES ==
+    void execute() {
+        for (std::size_t i = 0; i < cores.size(); i++) {
+            // Dont start any running process simulating if the CPU isn't even working on a process
+            if (!cores[i].cpu_idle) {
+                execute(cores[i], i);
+            }
+        }
+    }
+
+    void execute(cpu_core<Policy> &core, int core_number) {
+        PCB &process = job_list[core.running];
+        process_timers &timers = job_list.timers(core.running);
+        unsigned int io_time = Policy::io_clock(process, timers, current_time);
+        metrics.busy_time++;
+
+        // Decrement remaining time by 1ms for utilizing CPU
+        timers.remaining_time--;
+        if (Policy::time_sliced) {
+            timers.time_quantum_used++;
+        }
+
+        if (timers.remaining_time <= 0) {
+            // Process completes
+            trace.partition(current_time + 1, process.partition_number, -1); // Freed as of when the termination is logged
+            terminate_process(job_list, core.running, memory_paritions, terminated_count);
+            metrics.add(process, current_time + 1);
+            transitions.push_back({process.PID, RUNNING, TERMINATED, core_number});
+            release_CPU(core);
+
+        } else if (Policy::time_sliced && timers.time_quantum_used >= time_quantum) {
+            // Time quantum expires, move to back of ready queue
+            timers.state = READY;
+            make_ready(core.running, current_time + 1);
+            transitions.push_back({process.PID, RUNNING, READY, core_number});
+            release_CPU(core);
+
+        } else if (should_request_io(process, io_time)) {
+            timers.state = WAITING;
+            process.io_remaining_time = process.io_duration;
+            wait_queue.push(core.running, Policy::io_completion(process, current_time));
+            PROFILE_COUNT(wait_pushes);
+            transitions.push_back({process.PID, RUNNING, WAITING, core_number});
+            release_CPU(core);
+        }
+    }
+
+    // Find the next ms at which the main loop has to do something other than count down timers
+    // (and, for EP_RR, repeat the same memory log). Every ms before it can be skipped in bulk.
+    unsigned int next_event_time() const {
+        unsigned int next = next_arrival_time(list_processes, next_arrival);
+
+        // ...or a waiting process goes back to READY
+        next = std::min(next, wait_queue.next_completion());
+
+        for (const auto &core : cores) {
+            // An idle CPU with a non-empty ready queue (its own or one it can steal from) dispatches right away
+            if (core.cpu_idle) {
+                if (ready_count > 0) {
+                    return current_time;
+                }
+                continue;
+            }
+
+            const PCB &process = job_list[core.running];
+            const process_timers &timers = job_list.timers(core.running);
+
+            // Fall back to single stepping if the remaining time would wrap around
+            if (timers.remaining_time == 0) {
+                return current_time;
+            }
+
+            // The running process terminates during the ms it uses its last unit of CPU time
+            next = std::min(next, current_time + timers.remaining_time - 1);
+
+            // ...or is preempted during the ms its time quantum runs out
+            if (Policy::time_sliced) {
+                unsigned int until_preempt = (timers.time_quantum_used + 1 >= time_quantum) ? 0 : time_quantum - timers.time_quantum_used - 1;
+                next = std::min(next, current_time + until_preempt);
+            }
+
+            // ...or requests I/O once its I/O clock reaches the next multiple of io_freq
+            if (process.io_freq > 0) {
+                unsigned int io_time = Policy::io_clock(process, timers, current_time);
+                unsigned int until_io = (process.io_freq - io_time % process.io_freq) % process.io_freq;
+                next = std::min(next, current_time + until_io);
+            }
+        }
+
+        return next;
+    }
+
+    // Saves the state at the start of the current ms. It is written next to the checkpoint file and
+    // renamed over it once complete, so a run killed while saving still leaves the previous one.
+    bool save_checkpoint() {
+        if (pipeline) {
+            pipeline->flush();
+        }
+
+        checkpoint_header header;
+        header.policy = Policy::name;
+        header.time_quantum = time_quantum;
+        header.cores = cores.size();
+        header.run_to_completion = run_to_completion;
+        header.execution_offset = execution_status.position();
+        if (trace.output.file) {
+            header.trace_file = trace.filename;
+            header.trace_offset = trace.output.position();
+            header.trace_time = trace.last_time;
+        }
+        if (write_logs) {
+            if (memory_file.empty()) {
+                return false;
+            }
+            header.memory_file = memory_file;
+            header.memory_offset = memory_status.position();
+        }
+
+        std::string partial = std::string(checkpoint_file) + ".partial";
+        checkpoint_writer out;
+        if (!out.output.open(partial.c_str())) {
+            return false;
+        }
+        out.output.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        header.save(out);
+
+        out.put(write_logs);
+        out.put(current_time);
+        out.put(list_processes);
+        out.put(next_arrival);
+        out.put(job_list.cold);
+        out.put(job_list.hot);
+        out.put(terminated_count);
+        out.put(ready_count);
+        for (const auto &core : cores) {
+            save_queue(out, core.ready_queue);
+            out.put(core.running);
+            out.put(core.cpu_idle);
+        }
+        save_queue(out, wait_queue);
+        out.put(memory_paritions.partitions);
+        out.put(std::vector<unsigned int>(memory_paritions.starved.begin(), memory_paritions.starved.end()));
+
+        out.put(metrics.transitions);
+        out.put(metrics.completed);
+        out.put(metrics.total_turnaround);
+        out.put(metrics.total_waiting);
+        out.put(metrics.total_response);
+        out.put(metrics.busy_time);
+        out.put(metrics.steals);
+        save_histogram(out, metrics.turnaround);
+        save_histogram(out, metrics.waiting);
+        save_histogram(out, metrics.response);
+
+        out.output.close();
+        return std::rename(partial.c_str(), checkpoint_file) == 0;
+    }
+
+    // Loads the state saved by save_checkpoint, after its header has been read. The output sinks
+    // (memory_status included) have to be open at the offsets the header gives.
+    bool restore(checkpoint_reader &in) {
+        in.get(write_logs);
+        in.get(current_time);
+        in.get(list_processes);
+        in.get(next_arrival);
+        in.get(job_list.cold);
+        in.get(job_list.hot);
+        in.get(terminated_count);
+        in.get(ready_count);
+        for (auto &core : cores) {
+            load_queue(in, core.ready_queue);
+            in.get(core.running);
+            in.get(core.cpu_idle);
+        }
+        load_queue(in, wait_queue);
+        std::vector<memory_partition> partitions;
+        std::vector<unsigned int> starved;
+        in.get(partitions);
+        in.get(starved);
+        memory_paritions.restore(partitions, starved);
+
+        in.get(metrics.transitions);
+        in.get(metrics.completed);
+        in.get(metrics.total_turnaround);
+        in.get(metrics.total_waiting);
+        in.get(metrics.total_response);
+        in.get(metrics.busy_time);
+        in.get(metrics.steals);
+        load_histogram(in, metrics.turnaround);
+        load_histogram(in, metrics.waiting);
+        load_histogram(in, metrics.response);
+
+        resumed = true;
+        schedule_checkpoint();
+        return in.ok && job_list.cold.size() == job_list.hot.size() && (!write_logs || memory_status.file);
+    }
+
+    // Takes over the state of a simulation that ran up to now under another policy (or the same one
+    // with other settings), so it can be continued the way this one schedules. Every core keeps the
+    // processes queued on it, in the order the other policy would have run them.
+    template<typename Other>
+    void adopt(simulation<Other> &other) {
+        current_time = other.current_time;
+        list_processes = std::move(other.list_processes);
+        next_arrival = other.next_arrival;
+        job_list = std::move(other.job_list);
+        terminated_count = other.terminated_count;
+        wait_queue = std::move(other.wait_queue);
+        memory_paritions = std::move(other.memory_paritions);
+        metrics = other.metrics;
+        finished = other.finished;
+
+        ready_count = other.ready_count;
+        for (std::size_t i = 0; i < cores.size(); i++) {
+            cores[i].running = other.cores[i].running;
+            cores[i].cpu_idle = other.cores[i].cpu_idle;
+            while (!other.cores[i].ready_queue.empty()) {
+                int handle = Other::pick_next(other.cores[i].ready_queue);
+                Policy::enqueue(cores[i].ready_queue, handle, job_list[handle]);
+            }
+        }
+        other.ready_count = 0;
+        resumed = true;
+    }
+
+    // Prints the processes that were loaded, before anything runs
+    void print_debug() const {
+        std::cout << "\n=== DEBUG: PROCESSES LOADED ===" << std::endl;
+        std::cout << "Total processes loaded: " << list_processes.size() << std::endl;
+
+        if (list_processes.empty()) {
+            std::cout << "WARNING: No processes were loaded!" << std::endl;
+        } else {
+            std::cout << "PID | Size | Arrival | CPU Time | I/O Freq | I/O Dur | Priority | State" << std::endl;
+            std::cout << "----|------|---------|----------|----------|---------|----------|-------" << std::endl;
+
+            for (const auto& process : list_processes) {
+                std::cout << std::setw(3) << process.PID << " | "
+                          << std::setw(4) << process.size << " | "
+                          << std::setw(7) << process.arrival_time << " | "
+                          << std::setw(8) << process.processing_time << " | "
+                          << std::setw(8) << process.io_freq << " | "
+                          << std::setw(7) << process.io_duration << " | "
+                          << std::setw(8) << process.priority << " | "
+                          << process.state << std::endl;
+            }
+        }
+        std::cout << "=== END DEBUG ===\n" << std::endl;
+    }
+
+    void run() {
+        start();
+        run_until(NO_EVENT);
+        finish();
+    }
+
+    // Writes the output header and gets the input ready
+    void start() {
+        // Create output table header
+        if (write_logs && !resumed) {
+            if (multi_core()) {
+                execution_status << print_exec_header_cores();
+            } else {
+                execution_status << (Policy::style == TABLE_EP_RR ? print_exec_header_EP_RR() : print_exec_header());
+            }
+        }
+
+        if (print_loaded && !resumed) {
+            print_debug();
+        }
+
+        // Admit processes in arrival order through a cursor instead of scanning the whole list every ms
+        if (!resumed) {
+            sort_by_arrival(list_processes);
+        }
+
+        // The memory log of a run that saves checkpoints is kept next to them for resuming from. A restored
+        // run already has it open where the checkpoint left off.
+        if (write_logs && !memory_status.file && checkpoint_file) {
+            memory_file = std::string(checkpoint_file) + ".memory";
+            if (!memory_status.open(memory_file.c_str(), "w+b")) {
+                std::cerr << "Error: Unable to open file: " << memory_file << std::endl;
+                memory_file.clear();
+            }
+        }
+        if (write_logs && !memory_status.file) {
+            memory_status.open_temporary();
+        }
+
+        if (write_logs && threads > 1) {
+            pipeline = std::make_unique<log_pipeline>(execution_status, memory_status, threads - 1);
+        }
+    }
+
+    // Runs the main loop up to the start of stop_time, or until the simulation ends
+    void run_until(unsigned int stop_time) {
+        // Main simulation loop
+        while (!finished && current_time < stop_time) {
+            if (all_process_terminated(job_list, terminated_count) && !job_list.empty()
+                && !(run_to_completion && next_arrival < list_processes.size())) {
+                finished = true;
+                break;
+            }
+
+            /**
+             *                 --- LOGGING NOTE ---
+             * Admitting processes and putting processes from READY -> RUNNING if CPU is idle
+             * immediately logs into the execution summary (i.e. updates execution_status) as they
+             * occur immediatley upon the start of this ms
+             *
+             *
+             * Any process/logic that involves decrementing or incrementing over the course of a time unit
+             * stores into the transition tuple to log after the current_time variable increments by 1
+             * to accurately reflect the passing of 1ms. Thus, the actual execution of a running
+             * process and updating the wait queue postpone their log until after current_time++.
+             */
+            if (current_time >= next_checkpoint) {
+                PROFILE_PHASE(CHECKPOINT);
+                if (save_checkpoint()) {
+                    checkpoint_saved = true;
+                } else {
+                    std::cerr << "Error: Unable to save checkpoint: " << checkpoint_file << std::endl;
+                }
+                next_checkpoint = checkpoint_every > 0 ? current_time + checkpoint_every : NO_EVENT;
+            }
+
+            transitions.clear();
+            PROFILE_SAMPLE(ready_count, wait_queue.size());
+
+            {
+                PROFILE_PHASE(ADMIT);
+                admit_arrivals();
+            }
+            {
+                PROFILE_PHASE(SCHEDULE);
+                dispatch();
+            }
+            {
+                PROFILE_PHASE(WAIT_QUEUE);
+                complete_io();
+            }
+            {
+                PROFILE_PHASE(EXECUTE);
+                execute();
+            }
+
+            // === 5. INCREMENT CURRENT TIMER ===
+            current_time++;  // Every iteration of loop indicates 1ms (i.e. assumed time unit) passing
+
+            // === 6. LOG ALL POSTPONED TRANSITION EXECUTION LOGS ===
+            for (const auto& [pid, old_state, new_state, core] : transitions) {
+                log_transition(current_time, core, pid, old_state, new_state);
+            }
+
+            // === 7. LOG MEMORY ===
+            // EP_RR logs memory every ms, the others only along with the transitions
+            if (Policy::style == TABLE_EP_RR || !transitions.empty()) {
+                log_memory_status();
+            }
+
+            // === 8. SKIP AHEAD TO THE NEXT EVENT ===
+            // Nothing is admitted, dispatched or logged before the next event, so the ms in
+            // between only count down the running processes' timers and can be applied at once
+            unsigned int next_time = next_event_time();
+            if (next_time == NO_EVENT) {
+                finished = true;
+                break;  // Nothing left that could ever change state
+            }
+            // Stop at the next checkpoint or wherever the caller stops, so they happen at that exact ms
+            next_time = std::min({next_time, next_checkpoint, stop_time});
+            if (next_time > current_time) {
+                PROFILE_PHASE(SKIP_AHEAD);
+                unsigned int elapsed = next_time - current_time;
+                for (const auto &core : cores) {
+                    if (!core.cpu_idle) {
+                        job_list.timers(core.running).remaining_time -= elapsed;
+                        if (Policy::time_sliced) {
+                            job_list.timers(core.running).time_quantum_used += elapsed;
+                        }
+                        metrics.busy_time += elapsed;
+                    }
+                }
+
+                // Every skipped ms logs the same memory snapshot under its own time
+                if (Policy::style == TABLE_EP_RR && write_logs) {
+                    PROFILE_PHASE(LOG_MEMORY);
+                    memory_snapshot();
+                    if (!snapshot.empty() && pipeline) {
+                        pipeline->memory(current_time + 1, next_time, snapshot);
+                    } else if (!snapshot.empty()) {
+                        for (unsigned int time = current_time + 1; time <= next_time; time++) {
+                            memory_status << "Time: " << time << " - " << snapshot;
+                        }
+                    }
+                }
+                current_time = next_time;
+            }
+        }
+    }
+
+    // Closes the output once the main loop is done
+    void finish() {
+        metrics.finish_time = current_time;
+        metrics.stranded = job_list.size() - terminated_count;
+        metrics.never_admitted = list_processes.size() - next_arrival;
+        if (checkpoint_file && !checkpoint_saved) {
+            std::cerr << "Warning: The run ended at " << current_time << " ms, before its first checkpoint, so "
+                      << checkpoint_file << " was not written. Any file there is from another run." << std::endl;
+        }
+#ifdef INTERRUPTS_PROFILE
+        std::cerr << print_profile(profile, Policy::name);
+#endif
+        if (!write_logs) {
+            return;
+        }
+        if (pipeline) {
+            pipeline->finish();
+        }
+
+        // Close the output table and add memory analysis to execution file for bonus mark
+        if (multi_core()) {
+            execution_status << print_exec_footer_cores();
+            execution_status << "\n\n\n=== MEMORY ANALYSIS (BONUS) ===\n";
+        } else if (Policy::style == TABLE_BOXED) {
+            execution_status << print_exec_footer();
+            execution_status << "\n\n\n=== MEMORY ANALYSIS (BONUS) ===\n";
+        } else {
+            execution_status << "\n=== MEMORY ANALYSIS (BONUS) ===\n";
+        }
+        execution_status.append(memory_status);
+    }
+};
+
+//Runs one simulation of the given processes under Policy, streaming its output into execution_status
+template<typename Policy>
+schedule_metrics run_simulation(std::vector<PCB> list_processes, const simulation_settings &settings,
+                                output_sink &execution_status, trace_writer &trace) {
+    simulation<Policy> sim(std::move(list_processes), settings, execution_status, trace);
+    sim.run();
+    return sim.metrics;
+}
+
+
+//Calls action with a value of the policy called name, or returns false if there is no such policy
+template<typename Action>
+bool with_policy(const std::string &name, Action action) {
+    if (name == external_priorities::name) {
+        action(external_priorities{});
+    } else if (name == round_robin::name) {
+        action(round_robin{});
+    } else if (name == external_priorities_rr::name) {
+        action(external_priorities_rr{});
+    } else {
+        return false;
+    }
+    return true;
+}
+
+//Runs task(0) .. task(count - 1) on up to jobs threads (0 means one per hardware thread). Each
+//simulation owns all of its state, so independent simulations can be tasks.
+template<typename Task>
+void parallel_for(std::size_t count, unsigned int jobs, Task task) {
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    jobs = std::min<std::size_t>(jobs, std::max<std::size_t>(count, 1));
+
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < jobs; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+
+//----------------------------------------------ENTRY POINTS----------------------------------------------
+
+void print_usage(const char* program) {
+    std::cout << "To run the program, do: " << program << " <your_input_file.txt> [--policy <EP|RR|EP_RR>] [--quantum <ms>]"
+              << " [--cores <n>] [--threads <n>] [--checkpoint <file> --checkpoint-at <ms> | --checkpoint-every <ms>]"
+              << " [--trace <trace_file>] [--partitions <partition_file>] [--metrics <metrics_file or ->]"
+              << " [--stop-when <idle|done>]" << std::endl;
+}
+
+//Reads the processes in an input file, one per line
+bool load_processes(const char* file_name, std::vector<PCB> &list_process) {
+    mapped_file input_file;
+
+    // Ensure that the file actually opens
+    if (!input_file.open(file_name)) {
+        std::cerr << "Error: Unable to open file: " << file_name << std::endl;
+        return false;
+    }
+
+    // Parse the entire input file and populate a vector of PCBs
+    parse_error error;
+    if (!parse_processes(input_file.data, input_file.size, list_process, error)) {
+        std::cerr << "Error: " << file_name << ":" << error.line << ":" << error.column << ": " << error.message << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//Parses the command line into the options and settings, and reads the processes in the input file
+bool load_simulation(int argc, char** argv, simulator_options &options, simulation_settings &settings,
+                     std::vector<PCB> &list_process) {
+    // Get the input file (and optionally the options after it) from the user
+    if (argc < 2) {
+        std::cout << "ERROR!\nExpected an input file followed by options, received " << argc - 1 << " arguments" << std::endl;
+        print_usage(argv[0]);
+        return false;
+    }
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return false;
+    }
+
+    settings.time_quantum = options.time_quantum;
+    settings.cores = options.cores;
+    settings.threads = options.threads;
+    settings.checkpoint_file = options.checkpoint_file;
+    settings.checkpoint_at = options.checkpoint_at;
+    settings.checkpoint_every = options.checkpoint_every;
+    settings.run_to_completion = options.run_to_completion;
+    return setup_partitions(options, settings.layout) && load_processes(argv[1], list_process);
+}
+
+//Writes the metrics of a run where --metrics asked for them ("-" for stdout)
+bool report_metrics(const simulator_options &options, const schedule_metrics &metrics) {
+    if (!options.metrics_file) {
+        return true;
+    }
+    if (metrics.never_admitted > 0) {
+        std::cerr << "Warning: " << metrics.never_admitted << (metrics.never_admitted == 1 ? " input process" : " input processes")
+                  << " never arrived, the run stopped once every process admitted so far had terminated."
+                  << " Use --stop-when done to measure them all." << std::endl;
+    }
+    if (std::string(options.metrics_file) == "-") {
+        std::cout << print_metrics(metrics);
+        return true;
+    }
+    std::ofstream metrics_output(options.metrics_file);
+    if (!metrics_output.is_open()) {
+        std::cerr << "Error: Unable to open file: " << options.metrics_file << std::endl;
+        return false;
+    }
+    metrics_output << print_metrics(metrics);
+    return true;
+}
+
+//Reports a run that stopped with admitted processes that never terminated, which happens when nothing
+//is left that could change their state (e.g. an I/O of 0 ms under EP or RR never completes). Returns
+//false if there were any.
+bool check_stranded(const std::string &run, std::size_t stranded) {
+    if (stranded == 0) {
+        return true;
+    }
+    std::cerr << "Error: " << run << ": " << stranded << (stranded == 1 ? " process" : " processes")
+              << " never terminated, nothing left could change their state (an I/O duration of 0 never completes"
+              << " under EP or RR)" << std::endl;
+    return false;
+}
+
+//Reports a run that stopped before every input process arrived, which it does once every process admitted
+//so far has terminated unless it runs to completion. Returns false if any never arrived.
+bool check_admitted(const std::string &run, std::size_t never_admitted) {
+    if (never_admitted == 0) {
+        return true;
+    }
+    std::cerr << "Error: " << run << ": " << never_admitted << (never_admitted == 1 ? " input process" : " input processes")
+              << " never arrived, the run stopped once every process admitted so far had terminated" << std::endl;
+    return false;
+}
+
+//Runs the processes under Policy and writes execution.txt (and the trace, if one was asked for)
+template<typename Policy>
+int simulate(const simulator_options &options, const simulation_settings &settings, std::vector<PCB> list_process) {
+    // Optionally also record a compact binary trace of every transition (render it with bin/interrupts_trace)
+    trace_writer trace;
+    if (options.trace_file && !trace.open(options.trace_file, Policy::style)) {
+        std::cerr << "Error: Unable to open trace file: " << options.trace_file << std::endl;
+        return -1;
+    }
+
+    // With the list of processes, run the simulation and stream its output into the file
+    output_sink exec;
+    exec.open("execution.txt");
+    schedule_metrics metrics = run_simulation<Policy>(std::move(list_process), settings, exec, trace);
+
+    write_output(exec, "execution.txt");
+
+    // Optionally report the metrics that were computed along the way
+    bool reported = report_metrics(options, metrics);
+    return check_stranded("execution.txt", metrics.stranded) && reported ? 0 : -1;
+}
+
+//Continues the run saved in a checkpoint, whose header has been read, where it left off:
+//execution.txt (and the trace) are cut back to where they were and written on from there
+template<typename Policy>
+int resume(const simulator_options &options, const simulation_settings &settings, const checkpoint_header &header,
+           checkpoint_reader &checkpoint) {
+    trace_writer trace;
+    if (!header.trace_file.empty()) {
+        if (!trace.output.open_at(header.trace_file.c_str(), header.trace_offset)) {
+            std::cerr << "Error: Unable to continue trace file: " << header.trace_file << std::endl;
+            return -1;
+        }
+        trace.filename = header.trace_file;
+        trace.last_time = header.trace_time;
+    }
+
+    output_sink exec;
+    if (!exec.open_at("execution.txt", header.execution_offset)) {
+        std::cerr << "Error: Unable to continue execution.txt, it has to be the one the checkpoint was taken from" << std::endl;
+        return -1;
+    }
+
+    simulation<Policy> sim({}, settings, exec, trace);
+    if (!header.memory_file.empty()) {
+        if (!sim.memory_status.open_at(header.memory_file.c_str(), header.memory_offset)) {
+            std::cerr << "Error: Unable to continue " << header.memory_file << ", it has to be the one the checkpoint"
+                      << " was taken with" << std::endl;
+            return -1;
+        }
+        sim.memory_file = header.memory_file;
+    }
+    if (!sim.restore(checkpoint)) {
+        std::cerr << "Error: The checkpoint is truncated or damaged" << std::endl;
+        return -1;
+    }
+    if (settings.checkpoint_at != NO_EVENT && settings.checkpoint_at < sim.current_time) {
+        std::cerr << "Error: --checkpoint-at " << settings.checkpoint_at << " is before the checkpoint's own time, "
+                  << sim.current_time << " ms" << std::endl;
+        return -1;
+    }
+    sim.run();
+
+    write_output(exec, "execution.txt");
+    bool reported = report_metrics(options, sim.metrics);
+    return check_stranded("execution.txt", sim.metrics.stranded) && reported ? 0 : -1;
+}
+
+//main() of the single-policy binaries (interrupts_EP, interrupts_RR, interrupts_EP_RR)
+template<typename Policy>
+int simulator_main(int argc, char** argv) {
+    simulator_options options;
+    simulation_settings settings;
+    std::vector<PCB> list_process;
+    if (!load_simulation(argc, argv, options, settings, list_process)) {
+        return -1;
+    }
+
+    if (options.policy && std::string(options.policy) != Policy::name) {
+        std::cerr << "Error: This simulator only runs " << Policy::name << ", use bin/interrupts for other policies" << std::endl;
+        return -1;
+    }
+
+    return simulate<Policy>(options, settings, std::move(list_process));
+}
+
+#endif
@@ -0,0 +1,106 @@
+/**
+ * @file interrupts_101299776_101287534_generate.cpp
+ * @brief Generates reproducible synthetic workloads in the simulator's input format, for stress
+ *        testing with far more processes than the hand-written scenarios
+ *
+ */
+
+#include "interrupts_101299776_101287534_workload.hpp"
+
+
+void print_usage() {
+    std::cout << "To generate a workload, do: ./interrupts_generate [options] > workload.txt" << std::endl;
+    std::cout << "  --processes <n>          number of processes (default 1000)" << std::endl;
+    std::cout << "  --seed <n>               random seed; the same seed and options give the same file (default 1)" << std::endl;
+    std::cout << "  --out <file>             write to a file instead of stdout" << std::endl;
+    std::cout << "  --arrival <dist>         ms between arrivals (default exponential:20)" << std::endl;
+    std::cout << "  --burst <dist>           CPU time, at least 1 (default exponential:50)" << std::endl;
+    std::cout << "  --io-freq <dist>         I/O frequency of processes that do I/O, at least 1 (default uniform:5:50)" << std::endl;
+    std::cout << "  --io-duration <dist>     I/O duration (default uniform:1:20)" << std::endl;
+    std::cout << "  --io-fraction <0..1>     share of processes that do I/O (default 0.5)" << std::endl;
+    std::cout << "  --size <dist>            memory size in MB, at least 1 (default uniform:1:40)" << std::endl;
+    std::cout << "  --priority <dist>        also write a priority column" << std::endl;
+    std::cout << "  <dist> is fixed:<v>, uniform:<min>:<max>, exponential:<mean> or normal:<mean>:<stddev>" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    workload load;
+    const char* out_file = nullptr;
+
+    // Every option takes a value
+    for (int i = 1; i < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        bool valid = i + 1 < argc;
+        try {
+            if (!valid) {
+                // Missing value
+            } else if (option == "--processes") {
+                load.processes = std::stoull(value);
+            } else if (option == "--seed") {
+                load.seed = std::stoull(value);
+            } else if (option == "--out") {
+                out_file = argv[i + 1];
+            } else if (option == "--arrival") {
+                valid = load.arrival_gap.parse(value);
+            } else if (option == "--burst") {
+                valid = load.burst.parse(value);
+            } else if (option == "--io-freq") {
+                valid = load.io_freq.parse(value);
+            } else if (option == "--io-duration") {
+                valid = load.io_duration.parse(value);
+            } else if (option == "--io-fraction") {
+                load.io_fraction = std::stod(value);
+                valid = load.io_fraction >= 0 && load.io_fraction <= 1;
+            } else if (option == "--size") {
+                valid = load.size.parse(value);
+            } else if (option == "--priority") {
+                load.priorities = true;
+                valid = load.priority.parse(value);
+            } else {
+                valid = false;
+            }
+        } catch (const std::exception &) {
+            valid = false;
+        }
+
+        if (!valid) {
+            std::cout << "ERROR!\nInvalid option: " << option << " " << value << std::endl;
+            print_usage();
+            return -1;
+        }
+    }
+
+    if (load.processes > (unsigned long long) INT_MAX) {
+        std::cout << "ERROR!\nAt most " << INT_MAX << " processes, since PIDs are ints" << std::endl;
+        return -1;
+    }
+
+    output_sink output;
+    if (out_file) {
+        if (!output.open(out_file)) {
+            std::cerr << "Error: Unable to open file: " << out_file << std::endl;
+            return -1;
+        }
+    } else {
+        output.attach(stdout);
+    }
+
+    unsigned long long written = 0;
+    bool complete = generate_workload(load, [&](const PCB &process) {
+        output << process.PID << ", " << process.size << ", " << process.arrival_time << ", " << process.processing_time
+               << ", " << process.io_freq << ", " << process.io_duration;
+        if (load.priorities) {
+            output << ", " << process.priority;
+        }
+        output << '\n';
+        written++;
+    });
+    if (!complete) {
+        std::cerr << "Error: Arrival times overflow after " << written << " processes, use a smaller --arrival" << std::endl;
+        return -1;
+    }
+    output.close();
+
+    return 0;
+}
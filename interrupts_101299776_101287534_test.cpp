@@ -0,0 +1,449 @@
+/**
+ * @file interrupts_101299776_101287534_test.cpp
+ * @brief Regression test against the reference results: re-runs every scenario under every policy
+ *        in-process and compares the transition table and the memory analysis with the matching
+ *        output file row by row, reporting where the first difference is
+ *
+ */
+
+#include "interrupts_101299776_101287534_engine.hpp"
+#include <filesystem>
+#include <string_view>
+
+
+// One row of the execution table
+struct transition_row {
+    unsigned int        time;
+    int                 core;       // -1 in the single CPU tables
+    int                 PID;
+    std::string_view    old_state;
+    std::string_view    new_state;
+};
+
+// One entry of the memory analysis
+struct memory_entry {
+    unsigned int        time;
+    std::vector<int>    running;    // PID on each CPU, -1 when idle
+    unsigned int        ready = 0;
+    unsigned int        waiting = 0;
+    unsigned int        used = 0;
+    unsigned int        free = 0;
+    unsigned int        usable = 0;
+    std::vector<int>    partitions; // PID in each partition, -1 when free
+};
+
+// An output file taken apart into its rows. The views point into the text it was parsed from.
+struct parsed_output {
+    std::vector<transition_row> transitions;
+    std::vector<memory_entry>   memory;
+};
+
+//The number after the first label in text, past any spaces. False if the label is missing or isn't
+//followed by a number.
+bool number_after(std::string_view text, std::string_view label, long long &value) {
+    std::size_t position = text.find(label);
+    if (position == std::string_view::npos) {
+        return false;
+    }
+    position += label.size();
+    while (position < text.size() && text[position] == ' ') {
+        position++;
+    }
+    auto result = std::from_chars(text.data() + position, text.data() + text.size(), value);
+    return result.ec == std::errc();
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\r')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+//"| time | [core |] PID | old | new |", or false for borders, headers and anything else
+bool parse_transition(std::string_view line, transition_row &row) {
+    std::vector<std::string_view> cells;
+    std::size_t start = 1;
+    std::size_t bar;
+    while ((bar = line.find('|', start)) != std::string_view::npos) {
+        cells.push_back(trim(line.substr(start, bar - start)));
+        start = bar + 1;
+    }
+    if (cells.size() != 4 && cells.size() != 5) {
+        return false;
+    }
+
+    long long numbers[3] = {0, -1, 0};
+    std::size_t count = cells.size() - 2;
+    for (std::size_t i = 0; i < count; i++) {
+        auto result = std::from_chars(cells[i].data(), cells[i].data() + cells[i].size(), numbers[i]);
+        if (result.ec != std::errc() || result.ptr != cells[i].data() + cells[i].size()) {
+            return false; // The header row
+        }
+    }
+    row.time = numbers[0];
+    row.core = count == 3 ? numbers[1] : -1;
+    row.PID = count == 3 ? numbers[2] : numbers[1];
+    row.old_state = cells[count];
+    row.new_state = cells[count + 1];
+    return true;
+}
+
+//"IDLE", "PID 3" or "[PID 3, IDLE]"
+std::vector<int> parse_running(std::string_view text) {
+    std::vector<int> running;
+    std::size_t position = 0;
+    while (position < text.size()) {
+        std::size_t idle = text.find("IDLE", position);
+        std::size_t pid = text.find("PID", position);
+        if (idle == std::string_view::npos && pid == std::string_view::npos) {
+            break;
+        }
+        long long PID = -2; // Neither idle nor a PID, so it can't match a valid entry
+        if (idle < pid) {
+            running.push_back(-1);
+            position = idle + 4;
+        } else {
+            number_after(text.substr(pid), "PID", PID);
+            running.push_back(PID);
+            position = pid + 3;
+        }
+    }
+    return running;
+}
+
+//Takes the execution table and the memory analysis of an output file apart. Returns false with a
+//message if a memory log line is not in any of the layouts the simulators write.
+bool parse_output(std::string_view text, parsed_output &output, std::string &error) {
+    const std::string_view memory_title = "=== MEMORY ANALYSIS (BONUS) ===";
+    bool in_memory = false;
+    unsigned int line_number = 0;
+    std::size_t line_start = 0;
+
+    while (line_start < text.size()) {
+        std::size_t line_end = text.find('\n', line_start);
+        if (line_end == std::string_view::npos) {
+            line_end = text.size();
+        }
+        std::string_view line = trim(text.substr(line_start, line_end - line_start));
+        line_start = line_end + 1;
+        line_number++;
+
+        if (line.empty()) {
+            continue;
+        }
+        if (line == memory_title) {
+            in_memory = true;
+            continue;
+        }
+
+        if (!in_memory) {
+            transition_row row;
+            if (line.front() == '|' && parse_transition(line, row)) {
+                output.transitions.push_back(row);
+            }
+            continue;
+        }
+
+        long long values[3] = {0, 0, 0};
+        if (line.rfind("Time:", 0) == 0) {
+            // Time: <t> - Running: <running>, Ready: <n>, Waiting: <n>
+            std::size_t running = line.find("Running:");
+            std::size_t ready = line.find(", Ready:");
+            if (running == std::string_view::npos || ready == std::string_view::npos || ready < running
+                || !number_after(line, "Time:", values[0]) || !number_after(line, "Ready:", values[1])
+                || !number_after(line, "Waiting:", values[2])) {
+                error = "line " + std::to_string(line_number) + ": unreadable memory log entry";
+                return false;
+            }
+            memory_entry entry;
+            entry.time = values[0];
+            entry.running = parse_running(line.substr(running + 8, ready - running - 8));
+            entry.ready = values[1];
+            entry.waiting = values[2];
+            output.memory.push_back(entry);
+        } else if (output.memory.empty()) {
+            error = "line " + std::to_string(line_number) + ": memory details before the first memory log entry";
+            return false;
+        } else if (line.rfind("Memory - Used:", 0) == 0) {
+            // Memory - Used: <n>MB, Free: <n>MB, Usable: <n>MB
+            if (!number_after(line, "Used:", values[0]) || !number_after(line, "Free:", values[1])
+                || !number_after(line, "Usable:", values[2])) {
+                error = "line " + std::to_string(line_number) + ": unreadable memory totals";
+                return false;
+            }
+            memory_entry &entry = output.memory.back();
+            entry.used = values[0];
+            entry.free = values[1];
+            entry.usable = values[2];
+        } else if (line.rfind("Partitions:", 0) == 0) {
+            // Partitions: P1:free, P2:PID10, ... (EP_RR lists them on the lines that follow instead)
+            memory_entry &entry = output.memory.back();
+            std::string_view list = line.substr(11);
+            std::size_t start = 0;
+            while (start < list.size()) {
+                std::size_t comma = std::min(list.find(',', start), list.size());
+                std::string_view item = list.substr(start, comma - start);
+                long long PID = -1;
+                if (item.find("PID") != std::string_view::npos && !number_after(item, "PID", PID)) {
+                    error = "line " + std::to_string(line_number) + ": unreadable partition " + std::string(trim(item));
+                    return false;
+                }
+                if (!trim(item).empty()) {
+                    entry.partitions.push_back(PID);
+                }
+                start = comma + 1;
+            }
+        } else if (line.front() == '[') {
+            // [i] Size: <n>MB, Free | Occupied by PID <p>
+            long long PID = -1;
+            if (line.find("PID") != std::string_view::npos && !number_after(line, "PID", PID)) {
+                error = "line " + std::to_string(line_number) + ": unreadable partition";
+                return false;
+            }
+            output.memory.back().partitions.push_back(PID);
+        } else {
+            error = "line " + std::to_string(line_number) + ": unexpected line in the memory analysis";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string describe(const transition_row &row) {
+    std::string text = "time " + std::to_string(row.time);
+    if (row.core >= 0) {
+        text += ", core " + std::to_string(row.core);
+    }
+    return text + ", PID " + std::to_string(row.PID) + ": " + std::string(row.old_state) + " -> " + std::string(row.new_state);
+}
+
+std::string describe(const std::vector<int> &PIDs) {
+    std::string text;
+    for (std::size_t i = 0; i < PIDs.size(); i++) {
+        text += (i > 0 ? "," : "") + (PIDs[i] == -1 ? std::string("-") : std::to_string(PIDs[i]));
+    }
+    return "[" + text + "]";
+}
+
+//Where actual first differs from expected, or an empty string if they match
+std::string first_difference(const parsed_output &expected, const parsed_output &actual) {
+    const auto &rows = expected.transitions;
+    const auto &got = actual.transitions;
+    for (std::size_t i = 0; i < std::max(rows.size(), got.size()); i++) {
+        if (i >= got.size()) {
+            return "transition " + std::to_string(i + 1) + " is missing, expected " + describe(rows[i]);
+        }
+        if (i >= rows.size()) {
+            return "transition " + std::to_string(i + 1) + " is extra: " + describe(got[i]);
+        }
+        const transition_row &row = rows[i];
+        const transition_row &other = got[i];
+        if (row.time != other.time || row.core != other.core || row.PID != other.PID
+            || row.old_state != other.old_state || row.new_state != other.new_state) {
+            return "transition " + std::to_string(i + 1) + " differs: expected " + describe(row) + ", got " + describe(other);
+        }
+    }
+
+    const auto &entries = expected.memory;
+    const auto &logged = actual.memory;
+    for (std::size_t i = 0; i < std::max(entries.size(), logged.size()); i++) {
+        std::string where = "memory log entry " + std::to_string(i + 1);
+        if (i >= logged.size()) {
+            return where + " is missing, expected one at time " + std::to_string(entries[i].time);
+        }
+        if (i >= entries.size()) {
+            return where + " is extra, at time " + std::to_string(logged[i].time);
+        }
+
+        const memory_entry &entry = entries[i];
+        const memory_entry &other = logged[i];
+        where += " (time " + std::to_string(entry.time) + ")";
+        auto field = [&](const char* name, unsigned int first, unsigned int second) {
+            return where + " differs in " + name + ": expected " + std::to_string(first) + ", got " + std::to_string(second);
+        };
+        if (entry.time != other.time) {
+            return field("time", entry.time, other.time);
+        } else if (entry.running != other.running) {
+            return where + " differs in running: expected " + describe(entry.running) + ", got " + describe(other.running);
+        } else if (entry.ready != other.ready) {
+            return field("ready", entry.ready, other.ready);
+        } else if (entry.waiting != other.waiting) {
+            return field("waiting", entry.waiting, other.waiting);
+        } else if (entry.used != other.used) {
+            return field("used memory", entry.used, other.used);
+        } else if (entry.free != other.free) {
+            return field("free memory", entry.free, other.free);
+        } else if (entry.usable != other.usable) {
+            return field("usable memory", entry.usable, other.usable);
+        } else if (entry.partitions != other.partitions) {
+            return where + " differs in partitions: expected " + describe(entry.partitions) + ", got " + describe(other.partitions);
+        }
+    }
+    return "";
+}
+
+//Checks that the comparison notices a changed memory total: each of them in the first memory log entry
+//of a reference is changed in turn and compared with the original. Returns the first change that went
+//unnoticed, or an empty string.
+std::string self_check(const std::string &reference) {
+    parsed_output expected;
+    std::string error;
+    std::size_t memory = reference.find("=== MEMORY ANALYSIS");
+    if (!parse_output(reference, expected, error) || expected.memory.empty() || memory == std::string::npos) {
+        return "the reference has no memory log to change";
+    }
+
+    for (std::string label : {"Used: ", "Free: ", "Usable: "}) {
+        std::size_t at = reference.find(label, memory);
+        if (at == std::string::npos) {
+            return "the reference has no " + label + "total to change";
+        }
+        std::string changed = reference;
+        changed.insert(at + label.size(), "1"); // e.g. "Used: 10MB" becomes "Used: 110MB"
+
+        parsed_output actual;
+        if (!parse_output(changed, actual, error) || first_difference(expected, actual).empty()) {
+            return "a changed " + label + "total";
+        }
+    }
+    return "";
+}
+
+// One scenario under one policy, and how it compared
+struct test_case {
+    std::filesystem::path   input_file;
+    std::string             policy;
+    std::filesystem::path   reference_file;
+    bool                    passed = false;
+    std::string             message;
+};
+
+//Reads a whole file, false if it can't be read
+bool read_file(const std::filesystem::path &path, std::string &text) {
+    mapped_file file;
+    if (!file.open(path.c_str())) {
+        return false;
+    }
+    text.assign(file.data, file.size);
+    return true;
+}
+
+void run_test(test_case &test) {
+    std::vector<PCB> list_process;
+    std::string reference;
+    if (!load_processes(test.input_file.c_str(), list_process) || !read_file(test.reference_file, reference)) {
+        test.message = "unable to read the scenario or its reference";
+        return;
+    }
+
+    // The simulation writes into memory, the files in output_files are left alone
+    std::string result;
+    output_sink exec;
+    exec.capture(result);
+    trace_writer no_trace;
+    simulation_settings settings;
+    settings.print_loaded = false;
+    with_policy(test.policy, [&](auto policy_type) {
+        run_simulation<decltype(policy_type)>(std::move(list_process), settings, exec, no_trace);
+    });
+    exec.close();
+
+    parsed_output expected, actual;
+    std::string error;
+    if (!parse_output(reference, expected, error)) {
+        test.message = "reference " + error;
+        return;
+    }
+    if (!parse_output(result, actual, error)) {
+        test.message = "output " + error;
+        return;
+    }
+    test.message = first_difference(expected, actual);
+    test.passed = test.message.empty();
+}
+
+void print_test_usage(const char* program) {
+    std::cout << "To test, do: " << program << " [input directory] [reference directory] [--jobs <threads>]" << std::endl;
+    std::cout << "  Runs every scenario in the input directory (input_files by default) under every policy and compares"
+              << " the results with <reference directory>/<EP|RR|EPRR>_<scenario>.txt (output_files by default)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> directories;
+    unsigned int jobs = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 < argc && option == "--jobs") {
+            if (!parse_number(argv[++i], jobs)) {
+                std::cout << "ERROR!\nInvalid option: " << option << " " << argv[i] << std::endl;
+                print_test_usage(argv[0]);
+                return -1;
+            }
+        } else if (option.rfind("--", 0) != 0 && directories.size() < 2) {
+            directories.push_back(option);
+        } else {
+            std::cout << "ERROR!\nUnknown option: " << option << std::endl;
+            print_test_usage(argv[0]);
+            return -1;
+        }
+    }
+    std::filesystem::path input_dir = directories.size() > 0 ? directories[0] : "input_files";
+    std::filesystem::path reference_dir = directories.size() > 1 ? directories[1] : "output_files";
+
+    if (!std::filesystem::is_directory(input_dir) || !std::filesystem::is_directory(reference_dir)) {
+        std::cout << "ERROR!\nNo such directory: " << (std::filesystem::is_directory(input_dir) ? reference_dir : input_dir) << std::endl;
+        print_test_usage(argv[0]);
+        return -1;
+    }
+
+    std::vector<std::filesystem::path> scenarios;
+    for (const auto &entry : std::filesystem::directory_iterator(input_dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+            scenarios.push_back(entry.path());
+        }
+    }
+    std::sort(scenarios.begin(), scenarios.end());
+
+    // Every scenario with a reference under a policy is a test
+    std::vector<test_case> tests;
+    for (const char* policy : {external_priorities::name, round_robin::name, external_priorities_rr::name}) {
+        std::string prefix;
+        with_policy(policy, [&](auto policy_type) { prefix = decltype(policy_type)::file_prefix; });
+        for (const auto &scenario : scenarios) {
+            std::filesystem::path reference = reference_dir / (prefix + "_" + scenario.stem().string() + ".txt");
+            if (std::filesystem::exists(reference)) {
+                tests.push_back({scenario, policy, reference, false, ""});
+            }
+        }
+    }
+
+    parallel_for(tests.size(), jobs, [&](std::size_t i) { run_test(tests[i]); });
+
+    std::size_t failed = 0;
+    for (const auto &test : tests) {
+        if (!test.passed) {
+            failed++;
+            std::cout << "FAIL " << test.policy << " " << test.input_file.string() << ": " << test.message << std::endl;
+        }
+    }
+    std::cout << tests.size() - failed << " passed, " << failed << " failed" << std::endl;
+
+    // A comparison that misses differences would pass everything, so make sure it doesn't
+    for (const auto &test : tests) {
+        std::string reference;
+        if (test.passed && read_file(test.reference_file, reference)) {
+            std::string missed = self_check(reference);
+            if (!missed.empty()) {
+                std::cout << "SELF-CHECK FAILED: " << missed << " in " << test.reference_file.string()
+                          << " went unnoticed" << std::endl;
+                return 1;
+            }
+            break;
+        }
+    }
+    return failed == 0 && !tests.empty() ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file interrupts_101299776_101287534_trace.cpp
+ * @brief Renders a binary transition trace (written by the simulators with --trace) back into
+ *        the execution table, optionally filtered by PID and time range
+ *
+ */
+
+#include "interrupts_101299776_101287534.hpp"
+
+
+// Command line filters. Every record has to pass all of them to be printed.
+struct trace_filter {
+    bool            by_PID = false;
+    int             PID = 0;
+    unsigned int    from = 0;
+    unsigned int    to = UINT_MAX;
+    bool            partitions = false;     // Print partition changes instead of transitions
+};
+
+bool matches(const trace_filter &filter, const trace_entry &entry) {
+    if (filter.by_PID && entry.PID != filter.PID) {
+        return false;
+    }
+    return entry.time >= filter.from && entry.time <= filter.to;
+}
+
+//Parses all of text as a PID, which unlike the other numbers may be negative
+bool parse_PID(const std::string &text, int &PID) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), PID);
+    return !text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+void print_usage() {
+    std::cout << "To run the program, do: ./interrupts_trace <trace_file> [--pid <PID>] [--from <ms>] [--to <ms>] [--partitions]" << std::endl;
+    std::cout << "  --pid <PID>     only show this process" << std::endl;
+    std::cout << "  --from <ms>     only show records at or after this time" << std::endl;
+    std::cout << "  --to <ms>       only show records at or before this time" << std::endl;
+    std::cout << "  --partitions    show memory partition changes instead of state transitions" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "ERROR!\nExpected a trace file" << std::endl;
+        print_usage();
+        return -1;
+    }
+
+    // Parse the filters
+    trace_filter filter;
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool valid = true;
+        if (option == "--partitions") {
+            filter.partitions = true;
+        } else if (i + 1 < argc && option == "--pid") {
+            filter.by_PID = true;
+            valid = parse_PID(argv[++i], filter.PID);
+        } else if (i + 1 < argc && option == "--from") {
+            valid = parse_number(argv[++i], filter.from);
+        } else if (i + 1 < argc && option == "--to") {
+            valid = parse_number(argv[++i], filter.to);
+        } else {
+            std::cout << "ERROR!\nUnknown option: " << option << std::endl;
+            print_usage();
+            return -1;
+        }
+
+        if (!valid) {
+            std::cout << "ERROR!\nInvalid option: " << option << " " << argv[i] << std::endl;
+            print_usage();
+            return -1;
+        }
+    }
+
+    trace_reader trace;
+    if (!trace.open(argv[1])) {
+        std::cerr << "Error: " << argv[1] << " is not a trace file" << std::endl;
+        return -1;
+    }
+
+    output_sink output;
+    output.attach(stdout);
+
+    if (!filter.partitions) {
+        output << (trace.style == TABLE_EP_RR ? print_exec_header_EP_RR() : print_exec_header());
+    }
+
+    trace_entry entry;
+    while (trace.next(entry)) {
+        if (!matches(filter, entry)) {
+            continue;
+        }
+
+        if (!filter.partitions && entry.kind == TRACE_TRANSITION) {
+            print_exec_status(output, entry.time, entry.PID, entry.old_state, entry.new_state);
+        } else if (filter.partitions && entry.kind == TRACE_PARTITION) {
+            output << "Time: " << entry.time << " - P" << entry.partition_number << ": ";
+            if (entry.PID == -1) {
+                output << "free\n";
+            } else {
+                output << "PID " << entry.PID << "\n";
+            }
+        }
+    }
+
+    if (!filter.partitions && trace.style == TABLE_BOXED) {
+        output << print_exec_footer();
+    }
+    output.close();
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file interrupts_101299776_101287534_workload.hpp
+ * @brief Reproducible synthetic workloads, shared by the workload generator and the benchmarks
+ *
+ */
+
+#ifndef INTERRUPTS_WORKLOAD_HPP_
+#define INTERRUPTS_WORKLOAD_HPP_
+
+#include "interrupts_101299776_101287534.hpp"
+#include <cmath>
+
+
+// A distribution of non-negative integers, given on the command line as one of
+//   fixed:<value>
+//   uniform:<min>:<max>
+//   exponential:<mean>
+//   normal:<mean>:<stddev>
+// The samples are drawn from std::mt19937_64 with our own transforms rather than the std::
+// distributions, whose output differs between standard libraries, so a seed gives the same
+// workload everywhere.
+struct distribution {
+    enum kind { FIXED, UNIFORM, EXPONENTIAL, NORMAL };
+    kind   type = FIXED;
+    double first = 0;
+    double second = 0;
+
+    bool parse(const std::string &spec) {
+        auto parts = split_delim(spec, ":");
+        try {
+            if (parts[0] == "fixed" && parts.size() == 2) {
+                type = FIXED;
+                first = std::stod(parts[1]);
+            } else if (parts[0] == "uniform" && parts.size() == 3) {
+                type = UNIFORM;
+                first = std::stod(parts[1]);
+                second = std::stod(parts[2]);
+                return first >= 0 && first <= second;
+            } else if (parts[0] == "exponential" && parts.size() == 2) {
+                type = EXPONENTIAL;
+                first = std::stod(parts[1]);
+            } else if (parts[0] == "normal" && parts.size() == 3) {
+                type = NORMAL;
+                first = std::stod(parts[1]);
+                second = std::stod(parts[2]);
+            } else {
+                return false;
+            }
+        } catch (const std::exception &) {
+            return false;
+        }
+        return first >= 0 && second >= 0;
+    }
+
+    // Uniform in [0, 1)
+    static double unit(std::mt19937_64 &random) {
+        return (random() >> 11) * 0x1.0p-53;
+    }
+
+    unsigned long long sample(std::mt19937_64 &random) const {
+        double value = first;
+        switch (type) {
+            case FIXED:
+                break;
+            case UNIFORM: {
+                // Rejection sampling keeps every integer in [min, max] equally likely
+                unsigned long long low = std::llround(first);
+                unsigned long long range = std::llround(second) - low + 1;
+                unsigned long long limit = UINT64_MAX - UINT64_MAX % range;
+                unsigned long long bits;
+                do {
+                    bits = random();
+                } while (bits >= limit);
+                return low + bits % range;
+            }
+            case EXPONENTIAL:
+                value = -first * std::log(1.0 - unit(random));
+                break;
+            case NORMAL: {
+                // Box-Muller
+                double radius = std::sqrt(-2.0 * std::log(1.0 - unit(random)));
+                value = first + second * radius * std::cos(2.0 * M_PI * unit(random));
+                break;
+            }
+        }
+        return value <= 0 ? 0 : (unsigned long long) std::llround(std::min(value, (double) UINT_MAX));
+    }
+
+    //Stretches the distribution by factor, e.g. to cover a longer time horizon with the same shape
+    void scale(double factor) {
+        first *= factor;
+        second *= factor;
+    }
+};
+
+// What to generate. The defaults make processes that fit the default 100MB partition table.
+struct workload {
+    unsigned long long  processes = 1000;
+    unsigned long long  seed = 1;
+    distribution        arrival_gap = {distribution::EXPONENTIAL, 20, 0};  // ms between consecutive arrivals
+    distribution        burst = {distribution::EXPONENTIAL, 50, 0};        // CPU time, at least 1
+    distribution        io_freq = {distribution::UNIFORM, 5, 50};          // At least 1
+    distribution        io_duration = {distribution::UNIFORM, 1, 20};
+    distribution        size = {distribution::UNIFORM, 1, 40};             // MB, at least 1
+    double              io_fraction = 0.5;  // Share of processes that do any I/O
+    bool                priorities = false; // Draw a priority for each process (the optional 7th column)
+    distribution        priority;
+
+    //Scales every time in the workload, so the same mix of processes covers a longer horizon
+    void scale_times(double factor) {
+        arrival_gap.scale(factor);
+        burst.scale(factor);
+        io_freq.scale(factor);
+        io_duration.scale(factor);
+    }
+};
+
+//Generates the processes of a workload in arrival order, passing each PCB to emit. Returns false
+//(after emitting the processes before it) if the arrival times would overflow.
+template<typename Emit>
+bool generate_workload(const workload &load, Emit emit) {
+    std::mt19937_64 random(load.seed);
+    unsigned long long arrival_time = 0;
+    for (unsigned long long PID = 1; PID <= load.processes; PID++) {
+        if (PID > 1) {
+            arrival_time += load.arrival_gap.sample(random);
+        }
+        if (arrival_time > UINT_MAX - 1) {
+            return false;
+        }
+
+        unsigned long long size = std::max(1ULL, load.size.sample(random));
+        unsigned long long burst = std::max(1ULL, load.burst.sample(random));
+        unsigned long long io_freq = 0;
+        unsigned long long io_duration = 0;
+        if (distribution::unit(random) < load.io_fraction) {
+            io_freq = std::max(1ULL, load.io_freq.sample(random));
+            io_duration = load.io_duration.sample(random);
+        }
+        unsigned long long priority = load.priorities ? load.priority.sample(random) : PID;
+
+        emit(new_process(PID, size, arrival_time, burst, io_freq, io_duration, priority));
+    }
+    return true;
+}
+
+#endif
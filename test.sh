@@ -0,0 +1,12 @@
+#!/usr/bin/env bash
+
+INPUT_DIR="input_files"
+REFERENCE_DIR="output_files"
+
+# Re-runs every scenario under EP, RR and EP+RR in memory and compares the transitions and the
+# memory analysis with the reference results in $REFERENCE_DIR. Nothing is written there.
+echo "============================="
+echo "Checking all scenarios"
+echo "============================="
+
+./bin/interrupts_test "$INPUT_DIR" "$REFERENCE_DIR" "$@"